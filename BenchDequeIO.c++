@@ -0,0 +1,112 @@
+// -------------------------------
+// projects/deque/BenchDequeIO.c++
+// Copyright (C) 2014
+// Taylor Gregston
+// -------------------------------
+
+/*
+To compile the benchmark:
+    % g++-4.7 -pedantic -std=c++11 -O3 -Wall BenchDequeIO.c++ -o BenchDequeIO
+
+To run the benchmark:
+    % BenchDequeIO [elements] [file]
+
+Saves and loads a my_deque<long long> through a file, first element by element
+with a push_back rebuild, then with serialize/deserialize on a stream and on
+a file descriptor. Reports MB/s for each.
+*/
+
+// --------
+// includes
+// --------
+
+#include <chrono>    // steady_clock
+#include <cstdio>    // remove
+#include <cstdlib>   // atol
+#include <fstream>   // ifstream, ofstream
+#include <iostream>  // cout, endl
+#include <string>    // string
+
+#include <fcntl.h>   // open
+#include <unistd.h>  // close
+
+#include "Deque.h"
+
+// ----
+// time
+// ----
+
+/**
+ * @param   f the work to time
+ * @return  the time taken in milliseconds
+ */
+template <typename F>
+double time (F f) {
+    std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double, std::milli> x = std::chrono::steady_clock::now() - t;
+    return x.count();
+}
+
+// ------
+// report
+// ------
+
+void report (const char* name, double mb, double save, double load, bool same) {
+    std::cout << name << "save " << mb / save * 1000 << " MB/s, load " << mb / load * 1000
+              << " MB/s" << (same ? "" : " MISMATCH") << std::endl;
+}
+
+// ----
+// main
+// ----
+
+int main (int argc, char** argv) {
+    using namespace std;
+    const size_t n = (argc > 1) ? atol(argv[1]) : (1 << 21);
+    const string file = (argc > 2) ? argv[2] : "/tmp/BenchDequeIO.bin";
+    const double mb = n * sizeof(long long) / 1e6;
+
+    my_deque<long long> d(n);
+    for(size_t i = 0; i < n; ++i)
+        d[i] = i * 2654435761LL;
+    cout << "elements: " << n << " (" << mb << " MB)" << endl;
+
+    {
+        my_deque<long long> e;
+        double s = time([&] () {
+            ofstream out(file.c_str(), ios::binary);
+            for(my_deque<long long>::iterator it = d.begin(); it != d.end(); ++it)
+                out.write(reinterpret_cast<const char*>(&*it), sizeof(long long));});
+        double l = time([&] () {
+            ifstream in(file.c_str(), ios::binary);
+            long long v;
+            while(in.read(reinterpret_cast<char*>(&v), sizeof(v)))
+                e.push_back(v);});
+        report("element by element: ", mb, s, l, d == e);
+    }
+    {
+        my_deque<long long> e;
+        double s = time([&] () {
+            ofstream out(file.c_str(), ios::binary);
+            d.serialize(out);});
+        double l = time([&] () {
+            ifstream in(file.c_str(), ios::binary);
+            e.deserialize(in);});
+        report("stream serialize:   ", mb, s, l, d == e);
+    }
+    {
+        my_deque<long long> e;
+        double s = time([&] () {
+            int fd = open(file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            d.serialize(fd);
+            close(fd);});
+        double l = time([&] () {
+            int fd = open(file.c_str(), O_RDONLY);
+            e.deserialize(fd);
+            close(fd);});
+        report("fd serialize:       ", mb, s, l, d == e);
+    }
+    remove(file.c_str());
+    return 0;
+}
@@ -0,0 +1,92 @@
+// ------------------------------------
+// projects/deque/BenchDequeReclaim.c++
+// Copyright (C) 2014
+// Taylor Gregston
+// ------------------------------------
+
+/*
+To compile the benchmark:
+    % g++-4.7 -pedantic -std=c++11 -O3 -Wall BenchDequeReclaim.c++ -o BenchDequeReclaim -lpthread
+
+To run the benchmark:
+    % BenchDequeReclaim [elements]
+
+Times how long the caller is held up by clear() and by pop_front_n of half the values,
+for my_deques of strings and of shared_ptrs, destroying in place and with a
+deque_reclaimer. With the reclaimer it also reports how long the backlog took to drain.
+*/
+
+// --------
+// includes
+// --------
+
+#include <chrono>    // steady_clock
+#include <cstdlib>   // atol
+#include <iostream>  // cout, endl
+#include <memory>    // shared_ptr
+#include <string>    // string
+
+#include "Deque.h"
+#include "DequeReclaimer.h"
+
+// ----
+// time
+// ----
+
+/**
+ * @param   f the work to time
+ * @return  the time taken in milliseconds
+ */
+template <typename F>
+double time (F f) {
+    std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double, std::milli> x = std::chrono::steady_clock::now() - t;
+    return x.count();
+}
+
+// ---
+// run
+// ---
+
+/**
+ * fill a deque with make(i), then time clear() and pop_front_n with and without r
+ */
+template <typename T, typename F>
+void run (const char* name, size_t n, deque_reclaimer& r, F make) {
+    for(int deferred = 0; deferred < 2; ++deferred) {
+        my_deque<T> x;
+        for(size_t i = 0; i < n; ++i)
+            x.push_back(make(i));
+        if(deferred)
+            x.set_reclaimer(&r);
+        double pop = time([&] () {
+            x.pop_front_n(n / 2);});
+        double clear = time([&] () {
+            x.clear();});
+        double drain = time([&] () {
+            r.drain();});
+        std::cout << name << (deferred ? "reclaimer: " : "in place:  ") << "pop_front_n " << pop
+                  << " ms, clear " << clear << " ms";
+        if(deferred)
+            std::cout << ", drain " << drain << " ms";
+        std::cout << std::endl;
+    }
+}
+
+// ----
+// main
+// ----
+
+int main (int argc, char** argv) {
+    using namespace std;
+    const size_t n = (argc > 1) ? atol(argv[1]) : 4000000;
+    deque_reclaimer r;
+    cout << "elements: " << n << endl;
+    run<string>("string     ", n, r, [] (size_t i) {
+        return string(32, 'a' + i % 26);});
+    run< shared_ptr<long> >("shared_ptr ", n, r, [] (size_t i) {
+        return make_shared<long>(i);});
+    cout << "refused jobs: " << r.refused_jobs() << endl;
+    return 0;
+}
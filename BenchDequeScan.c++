@@ -0,0 +1,144 @@
+// ---------------------------------
+// projects/deque/BenchDequeScan.c++
+// Copyright (C) 2014
+// Taylor Gregston
+// ---------------------------------
+
+/*
+To compile the benchmark:
+    % g++-4.7 -pedantic -std=c++11 -O3 -Wall BenchDequeScan.c++ -o BenchDequeScan
+
+To run the benchmark:
+    % BenchDequeScan [elements] [repeats]
+
+Scans my_deque<long long>s much larger than the cache: an iterator sum, std::copy into
+a vector, and == and < between two equal deques. The rows come from a pool handed out in
+random order, the way they end up scattered in a long running process, so the hardware
+prefetcher cannot follow them. Every scan is repeated for several deque_prefetch::rows()
+distances, 0 being no prefetching.
+*/
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // copy, random_shuffle
+#include <chrono>    // steady_clock
+#include <cstdlib>   // atol, srand
+#include <iostream>  // cout, endl
+#include <memory>    // allocator
+#include <vector>    // vector
+
+#include "Deque.h"
+
+// -----------------
+// scatter_allocator
+// -----------------
+
+/**
+ * hands out row sized blocks from one big pool in a random order, anything else from
+ * std::allocator. nothing goes back to the pool
+ */
+template <typename T>
+class scatter_allocator : public std::allocator<T> {
+public:
+    template <typename U>
+    struct rebind {
+        typedef scatter_allocator<U> other;
+    };
+
+    static std::vector<T*>& pool () {
+        static std::vector<T*> p;
+        return p;
+    }
+
+    /**
+     * cut rows row sized blocks from one allocation and shuffle them
+     */
+    static void fill (size_t rows) {
+        T* block = std::allocator<T>().allocate(rows * INITIAL_ROW_SIZE);
+        for(size_t i = 0; i < rows; ++i)
+            pool().push_back(block + i * INITIAL_ROW_SIZE);
+        std::random_shuffle(pool().begin(), pool().end());
+    }
+
+    scatter_allocator () {}
+
+    template <typename U>
+    scatter_allocator (const scatter_allocator<U>&) {}
+
+    T* allocate (size_t n, const void* = 0) {
+        if((n != INITIAL_ROW_SIZE) || pool().empty())
+            return std::allocator<T>().allocate(n);
+        T* p = pool().back();
+        pool().pop_back();
+        return p;
+    }
+
+    void deallocate (T* p, size_t n) {
+        if(n != INITIAL_ROW_SIZE)
+            std::allocator<T>().deallocate(p, n);
+    }
+};
+
+// ----
+// time
+// ----
+
+/**
+ * @param   f the work to time
+ * @return  the best time of repeats runs in milliseconds
+ */
+template <typename F>
+double time (size_t repeats, F f) {
+    double best = 0;
+    for(size_t r = 0; r < repeats; ++r) {
+        std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+        f();
+        std::chrono::duration<double, std::milli> x = std::chrono::steady_clock::now() - t;
+        if(!r || (x.count() < best))
+            best = x.count();
+    }
+    return best;
+}
+
+// ----
+// main
+// ----
+
+int main (int argc, char** argv) {
+    using namespace std;
+    typedef my_deque<long long, scatter_allocator<long long> > deque_type;
+    const size_t n = (argc > 1) ? atol(argv[1]) : (1 << 24);
+    const size_t repeats = (argc > 2) ? atol(argv[2]) : 3;
+
+    srand(40);
+    scatter_allocator<long long>::fill(2 * (n / INITIAL_ROW_SIZE + 2));
+    deque_type x;
+    deque_type y;
+    for(size_t i = 0; i < n; ++i) {
+        x.push_back(i);
+        y.push_back(i);
+    }
+    vector<long long> v(n);
+    cout << "elements: " << n << " (" << 2 * n * sizeof(long long) / 1e6 << " MB in two deques)" << endl;
+
+    const size_t distances[] = {0, 1, 2, 4, 8};
+    for(size_t k = 0; k < sizeof(distances) / sizeof(distances[0]); ++k) {
+        deque_prefetch::rows() = distances[k];
+        long long s = 0;
+        double sum = time(repeats, [&] () {
+            for(deque_type::iterator it = x.begin(); it != x.end(); ++it)
+                s += *it;});
+        double copy = time(repeats, [&] () {
+            std::copy(x.begin(), x.end(), v.begin());});
+        bool same = true;
+        double equal = time(repeats, [&] () {
+            same = same && (x == y);});
+        double less = time(repeats, [&] () {
+            same = same && !(x < y);});
+        cout << "prefetch " << distances[k] << " rows: sum " << sum << " ms, copy " << copy
+             << " ms, == " << equal << " ms, < " << less << " ms (" << s + v[n / 2] << (same ? "" : " MISMATCH") << ")" << endl;
+    }
+    return 0;
+}
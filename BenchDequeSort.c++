@@ -0,0 +1,89 @@
+// ---------------------------------
+// projects/deque/BenchDequeSort.c++
+// Copyright (C) 2014
+// Taylor Gregston
+// ---------------------------------
+
+/*
+To compile the benchmark:
+    % g++-4.7 -pedantic -std=c++11 -O3 -Wall BenchDequeSort.c++ -o BenchDequeSort
+
+To run the benchmark:
+    % BenchDequeSort [values]
+
+Sorts the same random ints with std::sort on a std::vector and on a std::deque, and with
+my_deque::sort and my_deque::stable_sort, whose iterators std::sort does not take.
+Reports ms per sort.
+*/
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // sort, stable_sort
+#include <chrono>    // steady_clock
+#include <cstdlib>   // atol
+#include <deque>     // deque
+#include <iostream>  // cout, endl
+#include <vector>    // vector
+
+#include "Deque.h"
+
+// ----
+// time
+// ----
+
+/**
+ * @param   f the work to time
+ * @return  the time taken in milliseconds
+ */
+template <typename F>
+double time (F f) {
+    std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double, std::milli> x = std::chrono::steady_clock::now() - t;
+    return x.count();
+}
+
+// ----
+// main
+// ----
+
+int main (int argc, char** argv) {
+    using namespace std;
+    const size_t n = (argc > 1) ? atol(argv[1]) : (1 << 24);
+    vector<int> v(n);
+    unsigned r = 42;
+    for(size_t i = 0; i < n; ++i) {
+        r = r * 1103515245 + 12345;
+        v[i] = r >> 4;
+    }
+    cout << "values: " << n << endl;
+
+    vector<int> a(v);
+    cout << "std::sort std::vector:        " << time([&] () {
+        std::sort(a.begin(), a.end());}) << " ms" << endl;
+
+    vector<int> b(v);
+    cout << "std::stable_sort std::vector: " << time([&] () {
+        std::stable_sort(b.begin(), b.end());}) << " ms" << endl;
+
+    deque<int> d(v.begin(), v.end());
+    cout << "std::sort std::deque:         " << time([&] () {
+        std::sort(d.begin(), d.end());}) << " ms" << endl;
+
+    my_deque<int> x;
+    for(size_t i = 0; i < n; ++i)
+        x.push_back(v[i]);
+    cout << "my_deque::sort:               " << time([&] () {
+        x.sort();}) << " ms" << endl;
+
+    my_deque<int> y;
+    for(size_t i = 0; i < n; ++i)
+        y.push_back(v[i]);
+    cout << "my_deque::stable_sort:        " << time([&] () {
+        y.stable_sort();}) << " ms" << endl;
+
+    cout << "agree: " << (std::equal(a.begin(), a.end(), x.begin()) && (x == y)) << endl;
+    return 0;
+}
@@ -0,0 +1,205 @@
+// ----------------------------------
+// projects/deque/BenchMinMaxHeap.c++
+// Copyright (C) 2014
+// Taylor Gregston
+// ----------------------------------
+
+/*
+To compile the benchmark:
+    % g++-4.7 -pedantic -std=c++11 -O3 -Wall BenchMinMaxHeap.c++ -o BenchMinMaxHeap
+
+To run the benchmark:
+    % BenchMinMaxHeap [values]
+
+Fills a double-ended priority queue with random values, then runs a mix of
+push, pop_min and pop_max, then drains it from both ends. Compares
+minmax_heap against std::multiset and against a pair of std::priority_queues
+that share ids and skip entries the other one already popped.
+*/
+
+// --------
+// includes
+// --------
+
+#include <chrono>     // steady_clock
+#include <cstdlib>    // atol
+#include <functional> // greater
+#include <iostream>   // cout, endl
+#include <queue>      // priority_queue
+#include <set>        // multiset
+#include <utility>    // pair
+#include <vector>     // vector
+
+#include "Deque.h"
+#include "MinMaxHeap.h"
+
+// ---------
+// two_heaps
+// ---------
+
+/**
+ * the usual workaround: every value goes into a min heap and a max heap under one id,
+ * and a pop on one side marks the id dead so the other side skips it later
+ */
+class two_heaps {
+private:
+    typedef std::pair<int, size_t> entry;
+
+    std::priority_queue<entry, std::vector<entry>, std::greater<entry> > lo;
+    std::priority_queue<entry> hi;
+    std::vector<char> dead;
+    size_t live;
+
+    template <typename Q>
+    void skip (Q& q) {
+        while(dead[q.top().second])
+            q.pop();
+    }
+
+public:
+    two_heaps () : live(0) {}
+
+    void push (int v) {
+        lo.push(entry(v, dead.size()));
+        hi.push(entry(v, dead.size()));
+        dead.push_back(0);
+        ++live;
+    }
+
+    int pop_min () {
+        skip(lo);
+        entry e = lo.top();
+        lo.pop();
+        dead[e.second] = 1;
+        --live;
+        return e.first;
+    }
+
+    int pop_max () {
+        skip(hi);
+        entry e = hi.top();
+        hi.pop();
+        dead[e.second] = 1;
+        --live;
+        return e.first;
+    }
+
+    bool empty () const {
+        return !live;
+    }
+};
+
+// ---------
+// multi_set
+// ---------
+
+class multi_set {
+private:
+    std::multiset<int> s;
+
+public:
+    void push (int v) {
+        s.insert(v);
+    }
+
+    int pop_min () {
+        int v = *s.begin();
+        s.erase(s.begin());
+        return v;
+    }
+
+    int pop_max () {
+        std::multiset<int>::iterator it = --s.end();
+        int v = *it;
+        s.erase(it);
+        return v;
+    }
+
+    bool empty () const {
+        return s.empty();
+    }
+};
+
+// -----------
+// minmax_pops
+// -----------
+
+class minmax_pops {
+private:
+    minmax_heap<int> h;
+
+public:
+    void push (int v) {
+        h.push(v);
+    }
+
+    int pop_min () {
+        int v = h.min();
+        h.pop_min();
+        return v;
+    }
+
+    int pop_max () {
+        int v = h.max();
+        h.pop_max();
+        return v;
+    }
+
+    bool empty () const {
+        return h.empty();
+    }
+};
+
+// ---
+// run
+// ---
+
+/**
+ * fill with n values, run n mixed operations, then drain from both ends
+ * @param   n the number of values
+ * @param   sum set to a checksum of the popped values
+ * @return  the time taken in milliseconds
+ */
+template <typename Q>
+double run (size_t n, long long& sum) {
+    Q q;
+    unsigned r = 2014;
+    sum = 0;
+    std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < n; ++i) {
+        r = r * 1103515245 + 12345;
+        q.push(r >> 8);
+    }
+    for(size_t i = 0; i < n; ++i) {
+        r = r * 1103515245 + 12345;
+        switch((r >> 28) & 3) {
+        case 0: case 1: q.push(r >> 8);      break;
+        case 2:         sum += q.pop_min();  break;
+        default:        sum -= q.pop_max();  break;
+        }
+    }
+    for(bool low = true; !q.empty(); low = !low)
+        sum += low ? q.pop_min() : -q.pop_max();
+    std::chrono::duration<double, std::milli> x = std::chrono::steady_clock::now() - t;
+    return x.count();
+}
+
+// ----
+// main
+// ----
+
+int main (int argc, char** argv) {
+    using namespace std;
+    const size_t n = (argc > 1) ? atol(argv[1]) : 1000000;
+
+    long long s1, s2, s3;
+    double t1 = run<multi_set>(n, s1);
+    double t2 = run<two_heaps>(n, s2);
+    double t3 = run<minmax_pops>(n, s3);
+
+    cout << "values: " << n << endl;
+    cout << "std::multiset:            " << t1 << " ms (" << s1 << ")" << endl;
+    cout << "two std::priority_queues: " << t2 << " ms (" << s2 << ")" << endl;
+    cout << "minmax_heap:              " << t3 << " ms (" << s3 << ")" << endl;
+    return 0;
+}
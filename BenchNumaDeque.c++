@@ -0,0 +1,157 @@
+// ---------------------------------
+// projects/deque/BenchNumaDeque.c++
+// Copyright (C) 2014
+// Taylor Gregston
+// ---------------------------------
+
+/*
+To compile the benchmark:
+    % g++-4.7 -pedantic -std=c++11 -O3 -Wall -DDEQUE_LIBNUMA BenchNumaDeque.c++ -o BenchNumaDeque -lnuma -lpthread
+
+To run the benchmark:
+    % BenchNumaDeque [batches] [elements per batch] [passes]
+
+A producer pinned to the first node fills my_deque<long long> batches and hands them
+to a consumer pinned to the last node, which reads each batch passes times.
+Rows come from std::allocator, from numa_allocator on the producer's node, and from
+numa_allocator on the consumer's node. Reports M elements/s for each.
+Without -DDEQUE_LIBNUMA there is one node and the threads are not pinned.
+*/
+
+// --------
+// includes
+// --------
+
+#include <chrono>    // steady_clock
+#include <condition_variable> // condition_variable
+#include <cstdlib>   // atol
+#include <deque>     // deque
+#include <iostream>  // cout, endl
+#include <memory>    // allocator
+#include <mutex>     // mutex, unique_lock
+#include <thread>    // thread
+
+#include "Deque.h"
+#include "NumaAllocator.h"
+
+// -------
+// handoff
+// -------
+
+/**
+ * a bounded queue of batches between the two threads
+ */
+template <typename D>
+class handoff {
+private:
+    std::mutex lock;
+    std::condition_variable changed;
+    std::deque<D*> batches;
+    size_t depth;
+
+public:
+    explicit handoff (size_t depth_) :
+    depth(depth_)
+    {}
+
+    void put (D* d) {
+        std::unique_lock<std::mutex> guard(lock);
+        while(batches.size() == depth)
+            changed.wait(guard);
+        batches.push_back(d);
+        changed.notify_all();
+    }
+
+    D* take () {
+        std::unique_lock<std::mutex> guard(lock);
+        while(batches.empty())
+            changed.wait(guard);
+        D* d = batches.front();
+        batches.pop_front();
+        changed.notify_all();
+        return d;
+    }
+};
+
+// ------
+// run_on
+// ------
+
+void run_on (int node) {
+#ifdef DEQUE_LIBNUMA
+    if(numa_available() >= 0)
+        numa_run_on_node(node);
+#else
+    (void)node;
+#endif
+}
+
+// ---
+// run
+// ---
+
+/**
+ * @return  the time taken in milliseconds
+ */
+template <typename A>
+double run (const A& a, size_t batches, size_t n, size_t passes, int producer_node, int consumer_node, long long& sum) {
+    typedef my_deque<long long, A> deque_type;
+    handoff<deque_type> h(4);
+    sum = 0;
+    std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+
+    std::thread producer([&] () {
+        run_on(producer_node);
+        for(size_t b = 0; b < batches; ++b) {
+            deque_type* d = new deque_type(a);
+            for(size_t i = 0; i < n; ++i)
+                d->push_back(b * n + i);
+            h.put(d);
+        }});
+    std::thread consumer([&] () {
+        run_on(consumer_node);
+        for(size_t b = 0; b < batches; ++b) {
+            deque_type* d = h.take();
+            for(size_t p = 0; p < passes; ++p)
+                for(typename deque_type::iterator it = d->begin(); it != d->end(); ++it)
+                    sum += *it;
+            delete d;
+        }});
+    producer.join();
+    consumer.join();
+
+    std::chrono::duration<double, std::milli> x = std::chrono::steady_clock::now() - t;
+    return x.count();
+}
+
+// ------
+// report
+// ------
+
+void report (const char* name, double ms, size_t elements, long long sum) {
+    std::cout << name << ms << " ms, " << elements / ms / 1000 << " M elements/s (" << sum << ")" << std::endl;
+}
+
+// ----
+// main
+// ----
+
+int main (int argc, char** argv) {
+    using namespace std;
+    const size_t batches = (argc > 1) ? atol(argv[1]) : 64;
+    const size_t n = (argc > 2) ? atol(argv[2]) : (1 << 20);
+    const size_t passes = (argc > 3) ? atol(argv[3]) : 4;
+    const int producer_node = 0;
+    const int consumer_node = numa_arena::node_count() - 1;
+    cout << "nodes: " << numa_arena::node_count() << ", producer on " << producer_node
+         << ", consumer on " << consumer_node << endl;
+
+    long long sum;
+    double ms = run(allocator<long long>(), batches, n, passes, producer_node, consumer_node, sum);
+    report("std::allocator:          ", ms, batches * n, sum);
+    ms = run(numa_allocator<long long>(producer_node), batches, n, passes, producer_node, consumer_node, sum);
+    report("numa_allocator producer: ", ms, batches * n, sum);
+    ms = run(numa_allocator<long long>(consumer_node), batches, n, passes, producer_node, consumer_node, sum);
+    report("numa_allocator consumer: ", ms, batches * n, sum);
+    return 0;
+}
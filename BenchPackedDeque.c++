@@ -0,0 +1,121 @@
+// -----------------------------------
+// projects/deque/BenchPackedDeque.c++
+// Copyright (C) 2014
+// Taylor Gregston
+// -----------------------------------
+
+/*
+To compile the benchmark:
+    % g++-4.7 -pedantic -std=c++11 -O3 -Wall BenchPackedDeque.c++ -o BenchPackedDeque
+
+To run the benchmark:
+    % BenchPackedDeque [values]
+
+Builds a history of jittered 64 bit timestamps, an id sequence and random
+values in my_deque<long long> and packed_deque<long long>. Reports the
+compression ratio and the cost of a full scan and of random operator[] reads.
+*/
+
+// --------
+// includes
+// --------
+
+#include <chrono>    // steady_clock
+#include <cstdlib>   // atol
+#include <iostream>  // cout, endl
+#include <string>    // string
+
+#include "Deque.h"
+#include "PackedDeque.h"
+
+// ----
+// time
+// ----
+
+/**
+ * @param   f the work to time, returns a checksum
+ * @param   sum set to the checksum
+ * @return  the time taken in milliseconds
+ */
+template <typename F>
+double time (F f, long long& sum) {
+    std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+    sum = f();
+    std::chrono::duration<double, std::milli> x = std::chrono::steady_clock::now() - t;
+    return x.count();
+}
+
+// -------
+// measure
+// -------
+
+/**
+ * fill both deques from next and print the ratio and access times
+ */
+template <typename G>
+void measure (const std::string& name, size_t n, G next) {
+    using namespace std;
+    my_deque<long long> a(n);
+    packed_deque<long long> b;
+    for(size_t i = 0; i < n; ++i) {
+        long long v = next();
+        a[i] = v;
+        b.push_back(v);
+    }
+
+    long long s1, s2, s3, s4;
+    double t1 = time([&a] () {
+        long long s = 0;
+        for(my_deque<long long>::iterator it = a.begin(); it != a.end(); ++it)
+            s += *it;
+        return s;}, s1);
+    double t2 = time([&b] () {
+        long long s = 0;
+        for(packed_deque<long long>::const_iterator it = b.begin(); it != b.end(); ++it)
+            s += *it;
+        return s;}, s2);
+    double t3 = time([&a, n] () {
+        long long s = 0;
+        unsigned r = 3;
+        for(size_t i = 0; i < (1 << 20); ++i) {
+            r = r * 1103515245 + 12345;
+            s += a[r % n];
+        }
+        return s;}, s3);
+    double t4 = time([&b, n] () {
+        long long s = 0;
+        unsigned r = 3;
+        for(size_t i = 0; i < (1 << 20); ++i) {
+            r = r * 1103515245 + 12345;
+            s += b[r % n];
+        }
+        return s;}, s4);
+
+    cout << name << ": ratio " << (double)(n * sizeof(long long)) / b.bytes()
+         << " (" << b.packed_rows() << " packed rows)" << endl;
+    cout << "    scan:   my_deque " << t1 << " ms, packed_deque " << t2 << " ms"
+         << (s1 == s2 ? "" : " MISMATCH") << endl;
+    cout << "    random: my_deque " << t3 << " ms, packed_deque " << t4 << " ms"
+         << (s3 == s4 ? "" : " MISMATCH") << endl;
+}
+
+// ----
+// main
+// ----
+
+int main (int argc, char** argv) {
+    const size_t n = (argc > 1) ? atol(argv[1]) : (1 << 24);
+
+    long long t = 1400000000000000LL;
+    unsigned r = 1;
+    measure("timestamps", n, [&t, &r] () {
+        r = r * 1103515245 + 12345;
+        return t += 1000 + (r >> 27);});
+    long long id = 0;
+    measure("ids", n, [&id] () {return id++;});
+    unsigned long long x = 1;
+    measure("random", n, [&x] () {
+        x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+        return (long long)x;});
+    return 0;
+}
@@ -0,0 +1,90 @@
+// -----------------------------------
+// projects/deque/BenchRecordDeque.c++
+// Copyright (C) 2014
+// Taylor Gregston
+// -----------------------------------
+
+/*
+To compile the benchmark:
+    % g++-4.7 -pedantic -std=c++11 -O3 -Wall BenchRecordDeque.c++ -o BenchRecordDeque
+
+To run the benchmark:
+    % BenchRecordDeque [messages]
+
+Queues messages of 20 to 2000 bytes, keeping about 10000 in flight, and reads
+every message as it is popped. Compares my_deque<std::string>,
+std::deque<std::string> and record_deque.
+*/
+
+// --------
+// includes
+// --------
+
+#include <chrono>    // steady_clock
+#include <cstdlib>   // atol
+#include <deque>     // deque
+#include <iostream>  // cout, endl
+#include <string>    // string
+#include <vector>    // vector
+
+#include "Deque.h"
+#include "RecordDeque.h"
+
+// ---
+// run
+// ---
+
+/**
+ * push n messages through a queue with about 10000 in flight
+ * @param   m the messages to cycle through
+ * @param   n the number of messages to push
+ * @param   push adds a message
+ * @param   pop reads the oldest message, returns a checksum of it, and drops it
+ * @param   sum set to the checksum
+ * @return  the time taken in milliseconds
+ */
+template <typename Push, typename Pop>
+double run (const std::vector<std::string>& m, size_t n, Push push, Pop pop, long long& sum) {
+    sum = 0;
+    std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < n; ++i) {
+        push(m[i % m.size()]);
+        if(i >= 10000)
+            sum += pop();
+    }
+    std::chrono::duration<double, std::milli> x = std::chrono::steady_clock::now() - t;
+    return x.count();
+}
+
+// ----
+// main
+// ----
+
+int main (int argc, char** argv) {
+    using namespace std;
+    const size_t n = (argc > 1) ? atol(argv[1]) : 2000000;
+
+    vector<string> m;
+    unsigned r = 11;
+    for(int i = 0; i < 4096; ++i) {
+        r = r * 1103515245 + 12345;
+        m.push_back(string((r >> 8) % 1981 + 20, (char)('a' + i % 26)));
+    }
+
+    my_deque<string> a;
+    std::deque<string> b;
+    record_deque<> c;
+    long long s1, s2, s3;
+    double t1 = run(m, n, [&a] (const string& s) {a.push_back(s);},
+        [&a] () {long long x = a.front().size() + a.front()[0]; a.pop_front(); return x;}, s1);
+    double t2 = run(m, n, [&b] (const string& s) {b.push_back(s);},
+        [&b] () {long long x = b.front().size() + b.front()[0]; b.pop_front(); return x;}, s2);
+    double t3 = run(m, n, [&c] (const string& s) {c.push_back(s.data(), s.size());},
+        [&c] () {long long x = c.front().size() + c.front()[0]; c.pop_front(); return x;}, s3);
+
+    cout << "messages: " << n << endl;
+    cout << "my_deque<std::string>:   " << t1 << " ms (" << s1 << ")" << endl;
+    cout << "std::deque<std::string>: " << t2 << " ms (" << s2 << ")" << endl;
+    cout << "record_deque:            " << t3 << " ms (" << s3 << ")" << endl;
+    return 0;
+}
@@ -0,0 +1,115 @@
+// -------------------------------------
+// projects/deque/BenchSlidingWindow.c++
+// Copyright (C) 2014
+// Taylor Gregston
+// -------------------------------------
+
+/*
+To compile the benchmark:
+    % g++-4.7 -pedantic -std=c++11 -O3 -Wall BenchSlidingWindow.c++ -o BenchSlidingWindow
+
+To run the benchmark:
+    % BenchSlidingWindow [ticks]
+
+For window sizes from 16 to 65536 values, pushes random ticks through a
+count-based window and reads min, max and sum after every tick. Compares
+rescanning a my_deque window on each tick against sliding_window.
+Reports nanoseconds per tick.
+*/
+
+// --------
+// includes
+// --------
+
+#include <chrono>    // steady_clock
+#include <cstdlib>   // atol
+#include <iostream>  // cout, endl
+
+#include "Deque.h"
+#include "SlidingWindow.h"
+
+// ----
+// scan
+// ----
+
+/**
+ * recompute the aggregates over the whole window on every tick
+ * @return  nanoseconds per tick
+ */
+double scan (size_t window, size_t ticks, long long& check) {
+    my_deque<int> d;
+    size_t popped = 0;
+    unsigned r = 7;
+    check = 0;
+    std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < ticks; ++i) {
+        r = r * 1103515245 + 12345;
+        d.push_back((int)(r >> 12));
+        if(d.size() > window) {
+            d.pop_front();
+            //rebuild from the live rows the same way sliding_window does
+            if(++popped > d.size() + INITIAL_ROW_SIZE) {
+                my_deque<int> x(d);
+                d.swap(x);
+                popped = 0;
+            }
+        }
+        int lo = d.front(), hi = lo;
+        long long sum = 0;
+        for(my_deque<int>::iterator it = d.begin(); it != d.end(); ++it) {
+            lo = *it < lo ? *it : lo;
+            hi = *it > hi ? *it : hi;
+            sum += *it;
+        }
+        check += lo + hi + sum;
+    }
+    std::chrono::duration<double, std::nano> x = std::chrono::steady_clock::now() - t;
+    return x.count() / ticks;
+}
+
+// -----
+// slide
+// -----
+
+/**
+ * keep the aggregates with sliding_window
+ * @return  nanoseconds per tick
+ */
+double slide (size_t window, size_t ticks, long long& check) {
+    sliding_window<long long> w;
+    unsigned r = 7;
+    check = 0;
+    std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < ticks; ++i) {
+        r = r * 1103515245 + 12345;
+        w.push_back(i, (int)(r >> 12));
+        if(w.size() > window)
+            w.pop_front();
+        check += w.min() + w.max() + w.sum();
+    }
+    std::chrono::duration<double, std::nano> x = std::chrono::steady_clock::now() - t;
+    return x.count() / ticks;
+}
+
+// ----
+// main
+// ----
+
+int main (int argc, char** argv) {
+    using namespace std;
+    const size_t ticks = (argc > 1) ? atol(argv[1]) : 2000000;
+
+    cout << "ticks: " << ticks << endl;
+    cout << "window   rescan ns/tick   sliding_window ns/tick" << endl;
+    for(size_t window = 16; window <= 65536; window <<= 2) {
+        //the rescan is O(window) per tick, so give it fewer ticks on big windows
+        size_t scan_ticks = ticks / (window / 16);
+        if(scan_ticks < 4 * window)
+            scan_ticks = 4 * window;
+        long long c1, c2;
+        double t1 = scan(window, scan_ticks, c1);
+        double t2 = slide(window, ticks, c2);
+        cout << window << "\t " << t1 << "\t\t  " << t2 << endl;
+    }
+    return 0;
+}
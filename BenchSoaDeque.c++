@@ -0,0 +1,106 @@
+// -------------------------------
+// projects/deque/BenchSoaDeque.c++
+// Copyright (C) 2014
+// Taylor Gregston
+// -------------------------------
+
+/*
+To compile the benchmark:
+    % g++-4.7 -pedantic -std=c++11 -O3 -Wall BenchSoaDeque.c++ -o BenchSoaDeque
+
+To run the benchmark:
+    % BenchSoaDeque [records]
+
+Scans the price field of a queue of events stored as my_deque<event>
+(whole structs in rows) and as soa_deque<...> (one column per field).
+*/
+
+// --------
+// includes
+// --------
+
+#include <chrono>    // steady_clock
+#include <cstdlib>   // atol
+#include <iostream>  // cout, endl
+
+#include "Deque.h"
+#include "SoaDeque.h"
+
+// -----
+// event
+// -----
+
+struct event {
+    long long timestamp;
+    int       id;
+    double    price;
+    int       qty;
+};
+
+// ----
+// best
+// ----
+
+/**
+ * run f a few times
+ * @param   f the scan to time, returns a checksum
+ * @param   sum set to the checksum
+ * @return  the fastest run in milliseconds
+ */
+template <typename F>
+double best (F f, double& sum) {
+    double fastest = 1e30;
+    for(int r = 0; r < 5; ++r) {
+        std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+        sum = f();
+        std::chrono::duration<double, std::milli> d = std::chrono::steady_clock::now() - t;
+        if(d.count() < fastest)
+            fastest = d.count();
+    }
+    return fastest;
+}
+
+// ----
+// main
+// ----
+
+int main (int argc, char** argv) {
+    using namespace std;
+    const size_t n = (argc > 1) ? atol(argv[1]) : (1 << 22);
+
+    event zero = {0, 0, 0.0, 0};
+    my_deque<event> aos(n, zero);
+    soa_deque<long long, int, double, int> soa;
+    for(size_t i = 0; i < n; ++i) {
+        event e = {(long long)i, (int)i, i * 0.25, (int)(i & 7)};
+        aos[i] = e;
+        soa.push_back(e.timestamp, e.id, e.price, e.qty);
+    }
+
+    double s1, s2, s3;
+    double t1 = best([&aos] () {
+        double s = 0;
+        for(my_deque<event>::iterator it = aos.begin(); it != aos.end(); ++it)
+            s += it->price;
+        return s;}, s1);
+    double t2 = best([&aos, n] () {
+        double s = 0;
+        for(size_t i = 0; i < n; ++i)
+            s += aos[i].price;
+        return s;}, s2);
+    double t3 = best([&soa] () {
+        double s = 0;
+        for(size_t k = 0; k < soa.segment_count(); ++k) {
+            row_span<double> x = soa.segment<2>(k);
+            const double* p = x.data;
+            for(size_t i = 0; i < x.length; ++i)
+                s += p[i];
+        }
+        return s;}, s3);
+
+    cout << "records: " << n << endl;
+    cout << "my_deque<event> iterator scan:  " << t1 << " ms (" << s1 << ")" << endl;
+    cout << "my_deque<event> operator[] scan: " << t2 << " ms (" << s2 << ")" << endl;
+    cout << "soa_deque price column scan:     " << t3 << " ms (" << s3 << ")" << endl;
+    return 0;
+}
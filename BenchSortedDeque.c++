@@ -0,0 +1,105 @@
+// -----------------------------------
+// projects/deque/BenchSortedDeque.c++
+// Copyright (C) 2014
+// Taylor Gregston
+// -----------------------------------
+
+/*
+To compile the benchmark:
+    % g++-4.7 -pedantic -std=c++11 -O3 -Wall BenchSortedDeque.c++ -o BenchSortedDeque
+
+To run the benchmark:
+    % BenchSortedDeque [values] [queries]
+
+Fills a window of increasing timestamps and times lower_bound queries for random
+timestamps: std::lower_bound over my_deque iterators, which are bidirectional so every
+query walks, std::lower_bound over std::deque, and sorted_deque::lower_bound.
+Reports ns per query.
+*/
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // lower_bound
+#include <chrono>    // steady_clock
+#include <cstdlib>   // atol
+#include <deque>     // deque
+#include <iostream>  // cout, endl
+#include <vector>    // vector
+
+#include "Deque.h"
+#include "SortedDeque.h"
+
+// ----
+// time
+// ----
+
+/**
+ * @param   f the work to time
+ * @return  the time taken in milliseconds
+ */
+template <typename F>
+double time (F f) {
+    std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double, std::milli> x = std::chrono::steady_clock::now() - t;
+    return x.count();
+}
+
+// ------
+// report
+// ------
+
+void report (const char* name, double ms, size_t queries, long long sum) {
+    std::cout << name << ms * 1e6 / queries << " ns/query (" << sum << ")" << std::endl;
+}
+
+// ----
+// main
+// ----
+
+int main (int argc, char** argv) {
+    using namespace std;
+    const size_t n = (argc > 1) ? atol(argv[1]) : (1 << 22);
+    const size_t q = (argc > 2) ? atol(argv[2]) : 1000000;
+
+    my_deque<long long> m;
+    deque<long long> d;
+    sorted_deque<long long> s;
+    unsigned r = 42;
+    long long stamp = 0;
+    for(size_t i = 0; i < n; ++i) {
+        r = r * 1103515245 + 12345;
+        stamp += 1 + (r >> 24);
+        m.push_back(stamp);
+        d.push_back(stamp);
+        s.push_back(stamp);
+    }
+    vector<long long> keys(q);
+    for(size_t i = 0; i < q; ++i) {
+        r = r * 1103515245 + 12345;
+        keys[i] = (long long)(((unsigned long long)r << 16 ^ (r >> 8)) % stamp);
+    }
+    cout << "values: " << n << ", queries: " << q << endl;
+
+    long long sum = 0;
+    const size_t slow = std::min<size_t>(q, 100); //a walk per query, so only a few
+    double ms = time([&] () {
+        for(size_t i = 0; i < slow; ++i)
+            sum += *std::lower_bound(m.begin(), m.end(), keys[i]);});
+    report("my_deque std::lower_bound:  ", ms, slow, sum);
+
+    sum = 0;
+    ms = time([&] () {
+        for(size_t i = 0; i < q; ++i)
+            sum += *std::lower_bound(d.begin(), d.end(), keys[i]);});
+    report("std::deque std::lower_bound:", ms, q, sum);
+
+    sum = 0;
+    ms = time([&] () {
+        for(size_t i = 0; i < q; ++i)
+            sum += s[s.lower_bound(keys[i])];});
+    report("sorted_deque::lower_bound:  ", ms, q, sum);
+    return 0;
+}
@@ -0,0 +1,89 @@
+// ---------------------------------
+// projects/deque/BenchTreeDeque.c++
+// Copyright (C) 2014
+// Taylor Gregston
+// ---------------------------------
+
+/*
+To compile the benchmark:
+    % g++-4.7 -pedantic -std=c++11 -O3 -Wall BenchTreeDeque.c++ -o BenchTreeDeque
+
+To run the benchmark:
+    % BenchTreeDeque [elements] [operations]
+
+Runs the same stream of inserts, erases and reads at random positions
+against my_deque, std::deque and tree_deque and reports the time of each.
+*/
+
+// --------
+// includes
+// --------
+
+#include <chrono>    // steady_clock
+#include <cstdlib>   // atol
+#include <deque>     // deque
+#include <iostream>  // cout, endl
+
+#include "Deque.h"
+#include "TreeDeque.h"
+
+// ---
+// run
+// ---
+
+/**
+ * apply ops middle-heavy operations to d: 40% insert, 40% erase, 20% read,
+ * all at random positions
+ * @param   d the container, filled beforehand
+ * @param   ops the number of operations
+ * @param   sum set to a checksum of the reads
+ * @return  the time taken in milliseconds
+ */
+template <typename D, typename I, typename E>
+double run (D& d, size_t ops, long long& sum, I insert, E erase) {
+    unsigned r = 4242;
+    sum = 0;
+    std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < ops; ++i) {
+        r = r * 1103515245 + 12345;
+        size_t p = (r >> 4) % d.size();
+        switch((r >> 28) % 5) {
+        case 0: case 1: insert(d, p, (int)i); break;
+        case 2: case 3: erase(d, p);          break;
+        default:        sum += d[p];          break;
+        }
+    }
+    std::chrono::duration<double, std::milli> x = std::chrono::steady_clock::now() - t;
+    return x.count();
+}
+
+// ----
+// main
+// ----
+
+int main (int argc, char** argv) {
+    using namespace std;
+    const size_t n   = (argc > 1) ? atol(argv[1]) : 100000;
+    const size_t ops = (argc > 2) ? atol(argv[2]) : 50000;
+
+    my_deque<int>   a(n, 1);
+    std::deque<int> b(n, 1);
+    tree_deque<int> c(n, 1);
+
+    long long s1, s2, s3;
+    double t1 = run(a, ops, s1,
+        [] (my_deque<int>& d, size_t p, int v) {d.insert(d.begin() + p, v);},
+        [] (my_deque<int>& d, size_t p) {d.erase(d.begin() + p);});
+    double t2 = run(b, ops, s2,
+        [] (std::deque<int>& d, size_t p, int v) {d.insert(d.begin() + p, v);},
+        [] (std::deque<int>& d, size_t p) {d.erase(d.begin() + p);});
+    double t3 = run(c, ops, s3,
+        [] (tree_deque<int>& d, size_t p, int v) {d.insert(p, v);},
+        [] (tree_deque<int>& d, size_t p) {d.erase(p);});
+
+    cout << "elements: " << n << ", operations: " << ops << endl;
+    cout << "my_deque:   " << t1 << " ms (" << s1 << ")" << endl;
+    cout << "std::deque: " << t2 << " ms (" << s2 << ")" << endl;
+    cout << "tree_deque: " << t3 << " ms (" << s3 << ")" << endl;
+    return 0;
+}
@@ -0,0 +1,239 @@
+// ----------------------------------
+// projects/deque/CountingAllocator.h
+// Copyright (C) 2014
+// Taylor Gregston
+// ----------------------------------
+
+#ifndef CountingAllocator_h
+#define CountingAllocator_h
+
+// --------
+// includes
+// --------
+
+#include <cstddef>   // size_t, ptrdiff_t
+#include <memory>    // allocator
+#include <new>       // placement new
+#include <utility>   // forward
+
+// ----------------
+// allocation_stats
+// ----------------
+
+/**
+ * What every counting_allocator has done since the last reset, whatever its value_type,
+ * so a container's element rows and its map of row pointers are counted together.
+ */
+struct allocation_stats {
+    size_t allocations;   //calls to allocate
+    size_t deallocations; //calls to deallocate
+    size_t bytes;         //bytes handed out in total
+    size_t live;          //bytes handed out and not yet given back
+    size_t peak;          //the most live bytes at any time
+
+    static allocation_stats& get () {
+        static allocation_stats s = {0, 0, 0, 0, 0};
+        return s;
+    }
+
+    static void reset () {
+        allocation_stats& s = get();
+        s.allocations = s.deallocations = s.bytes = 0;
+        s.peak = s.live;
+    }
+};
+
+// ------------------
+// counting_allocator
+// ------------------
+
+/**
+ * A std::allocator that records its calls in allocation_stats.
+ * All instances are interchangeable, so they compare equal.
+ */
+template <typename T>
+class counting_allocator {
+public:
+    // --------
+    // typedefs
+    // --------
+
+    typedef T              value_type;
+    typedef size_t         size_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef T*             pointer;
+    typedef const T*       const_pointer;
+    typedef T&             reference;
+    typedef const T&       const_reference;
+
+    template <typename U>
+    struct rebind {
+        typedef counting_allocator<U> other;
+    };
+
+public:
+    /**
+     * @return  true, any counting_allocator can free what another one allocated
+     */
+    friend bool operator == (const counting_allocator&, const counting_allocator&) {
+        return true;
+    }
+
+    friend bool operator != (const counting_allocator&, const counting_allocator&) {
+        return false;
+    }
+
+public:
+    // ------------
+    // constructors
+    // ------------
+
+    counting_allocator () {}
+
+    template <typename U>
+    counting_allocator (const counting_allocator<U>&) {}
+
+    // --------
+    // allocate
+    // --------
+
+    /**
+     * @param   n the number of objects to make room for
+     * @return  uninitialized room for n objects
+     */
+    pointer allocate (size_type n, const void* = 0) {
+        allocation_stats& s = allocation_stats::get();
+        ++s.allocations;
+        s.bytes += n * sizeof(T);
+        s.live += n * sizeof(T);
+        if(s.live > s.peak)
+            s.peak = s.live;
+        return std::allocator<T>().allocate(n);
+    }
+
+    // ----------
+    // deallocate
+    // ----------
+
+    /**
+     * @param   p room from allocate(n)
+     * @param   n the same n
+     */
+    void deallocate (pointer p, size_type n) {
+        allocation_stats& s = allocation_stats::get();
+        ++s.deallocations;
+        s.live -= n * sizeof(T);
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    // ---------
+    // construct
+    // ---------
+
+    template <typename U, typename... Args>
+    void construct (U* p, Args&&... args) {
+        new (p) U(std::forward<Args>(args)...);
+    }
+
+    // -------
+    // destroy
+    // -------
+
+    template <typename U>
+    void destroy (U* p) {
+        p->~U();
+    }
+
+    // --------
+    // max_size
+    // --------
+
+    size_type max_size () const {
+        return size_type(-1) / sizeof(T);
+    }
+};
+
+// -------------
+// element_stats
+// -------------
+
+/**
+ * What has happened to tracked values since the last reset.
+ */
+struct element_stats {
+    size_t constructions; //default and value constructions
+    size_t copies;        //copy constructions and copy assignments
+    size_t moves;         //move constructions and move assignments
+    size_t destructions;
+
+    static element_stats& get () {
+        static element_stats s = {0, 0, 0, 0};
+        return s;
+    }
+
+    static void reset () {
+        element_stats& s = get();
+        s.constructions = s.copies = s.moves = s.destructions = 0;
+    }
+
+    /**
+     * @return  every construction, copy and move, what an operation costs in elements
+     */
+    static size_t touched () {
+        const element_stats& s = get();
+        return s.constructions + s.copies + s.moves;
+    }
+};
+
+// -------
+// tracked
+// -------
+
+/**
+ * An int that records its special member calls in element_stats.
+ */
+struct tracked {
+    int value;
+
+    tracked () : value(0) {
+        ++element_stats::get().constructions;
+    }
+
+    tracked (int v) : value(v) {
+        ++element_stats::get().constructions;
+    }
+
+    tracked (const tracked& that) : value(that.value) {
+        ++element_stats::get().copies;
+    }
+
+    tracked (tracked&& that) : value(that.value) {
+        ++element_stats::get().moves;
+    }
+
+    tracked& operator = (const tracked& that) {
+        value = that.value;
+        ++element_stats::get().copies;
+        return *this;
+    }
+
+    tracked& operator = (tracked&& that) {
+        value = that.value;
+        ++element_stats::get().moves;
+        return *this;
+    }
+
+    ~tracked () {
+        ++element_stats::get().destructions;
+    }
+
+    friend bool operator == (const tracked& lhs, const tracked& rhs) {
+        return lhs.value == rhs.value;
+    }
+
+    friend bool operator < (const tracked& lhs, const tracked& rhs) {
+        return lhs.value < rhs.value;
+    }
+};
+
+#endif // CountingAllocator_h
@@ -12,12 +12,21 @@
 // includes
 // --------
 
-#include <algorithm> // copy, equal, lexicographical_compare, max, swap
+#include <algorithm> // copy, equal, lexicographical_compare, max, min, swap
 #include <cassert>   // assert
+#include <cerrno>    // errno, EINTR
+#include <cstring>   // memcmp, memcpy
+#include <functional> // less
+#include <istream>   // istream
 #include <iterator>  // iterator, bidirectional_iterator_tag
 #include <memory>    // allocator
-#include <stdexcept> // out_of_range
-#include <utility>   // !=, <=, >, >=
+#include <ostream>   // ostream
+#include <stdexcept> // out_of_range, runtime_error
+#include <type_traits> // integral_constant, is_trivially_copyable
+#include <utility>   // !=, <=, >, >=, move
+#include <vector>    // vector
+
+#include <sys/uio.h> // iovec, readv, writev
 
 // -----
 // using
@@ -44,6 +53,81 @@ using std::rel_ops::operator>=;
 #define INITIAL_ROW_SIZE    16  // THIS VALUE MUST BE == 2^DIV_ROW_SHIFT
 #define MOD_ROW_MASK        15  // THIS VALUE MUST BE == INITIAL_ROW_SIZE - 1
 
+#define CACHE_LINE_SIZE     64  // bytes per cache line on the machines we target
+
+/**
+ * Rows are separate heap blocks, so the hardware prefetcher cannot guess where the next
+ * one is. Iterators crossing into a row, and the row walks behind == and <, prefetch the
+ * row PREFETCH_ROWS further on. The default can be changed with -DPREFETCH_ROWS=n and the
+ * distance at run time with deque_prefetch::rows(); 0 turns prefetching off.
+ */
+
+#ifndef PREFETCH_ROWS
+#define PREFETCH_ROWS       4   // rows ahead to prefetch
+#endif
+
+/**
+ * sort orders the values in runs of about SORT_RUN_BYTES, each moved into one contiguous
+ * block that stays in cache while it is sorted, and then merges the runs.
+ */
+
+#ifndef SORT_RUN_BYTES
+#define SORT_RUN_BYTES      1048576 // about half of an L2 cache
+#endif
+
+/**
+ * my_deque<bool> packs WORD_BITS flags into each word of a row, so a row
+ * holds ROW_BITS flags and the same shift/mask trick finds a flag's row.
+ */
+
+#define DIV_WORD_SHIFT      6   // THIS VALUE MUST BE == log2(WORD_BITS)
+#define WORD_BITS           64  // bits in an unsigned long long
+#define MOD_WORD_MASK       63  // THIS VALUE MUST BE == WORD_BITS - 1
+#define ROW_BIT_SHIFT       (DIV_ROW_SHIFT + DIV_WORD_SHIFT)
+#define ROW_BITS            (INITIAL_ROW_SIZE * WORD_BITS)
+
+// --------
+// row_span
+// --------
+
+/**
+ * A contiguous run of elements inside one row.
+ */
+template <typename E>
+struct row_span {
+    E*     data;   //first element of the run
+    size_t length; //how many elements
+
+    E* begin () const {
+        return data;
+    }
+
+    E* end () const {
+        return data + length;
+    }
+
+    size_t size () const {
+        return length;
+    }
+
+    E& operator [] (size_t i) const {
+        return data[i];
+    }
+};
+
+// --------------
+// deque_prefetch
+// --------------
+
+/**
+ * The prefetch distance every my_deque uses, in rows.
+ */
+struct deque_prefetch {
+    static size_t& rows () {
+        static size_t r = PREFETCH_ROWS;
+        return r;
+    }
+};
 
 // -------
 // destroy
@@ -96,6 +180,71 @@ BI uninitialized_fill (A& a, BI b, BI e, const U& v) {
     return e;
 }
 
+// --------
+// deque_io
+// --------
+
+/**
+ * my_deque::serialize and deserialize write a DEQUE_IO_HEADER byte header: the magic
+ * DEQUE_IO_MAGIC, a version, sizeof(T), a reserved word and the element count, all in
+ * native byte order. Trivially copyable elements follow as raw bytes, one block per row;
+ * the fd variants hand DEQUE_IO_BATCH rows at a time to writev/readv.
+ */
+
+#define DEQUE_IO_MAGIC      "MYDQ"
+#define DEQUE_IO_VERSION    1
+#define DEQUE_IO_HEADER     24
+#define DEQUE_IO_BATCH      512 // rows per writev/readv, below IOV_MAX
+
+/**
+ * The customization point for serializing elements of type T.
+ * Trivially copyable types are copied as bytes. For any other type, specialize deque_io<T>
+ * with bulk = false and
+ *     static void write (std::ostream& out, const T& v);
+ *     static T read (std::istream& in);
+ * Only the stream variants can use a specialization.
+ */
+template <typename T, bool = std::is_trivially_copyable<T>::value>
+struct deque_io {
+    static const bool bulk = true;
+};
+
+template <typename T>
+struct deque_io<T, false>; // not serializable until specialized
+
+// -----------
+// reclaim_job
+// -----------
+
+/**
+ * Rows detached from a my_deque whose values have not been destroyed nor the rows freed
+ * yet. run() does both, on whatever thread calls it.
+ */
+struct reclaim_job {
+    size_t rows;    //rows run() frees, what the job counts for in a backlog
+
+    virtual void run () = 0;
+
+    virtual ~reclaim_job () {}
+};
+
+// ------------
+// reclaim_sink
+// ------------
+
+/**
+ * Where a my_deque with a reclaimer sends the rows that clear(), its destructor and
+ * pop_front_n detach. take() owns the job when it returns true; when it returns false
+ * the deque runs the job itself. deque_reclaimer in DequeReclaimer.h is the one to use.
+ */
+class reclaim_sink {
+public:
+    virtual bool take (reclaim_job* j) = 0;
+
+protected:
+    ~reclaim_sink () {}
+};
+
 // -------
 // my_deque
 // -------
@@ -131,7 +280,9 @@ public:
      * @return  true if the lhs and rhs have same value and number of items
      */
     friend bool operator == (const my_deque& lhs, const my_deque& rhs) {
-        return (lhs.size() == rhs.size()) && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+        return (lhs.size() == rhs.size()) &&
+               zip_runs(lhs, rhs, lhs.size(), [] (const T* p, const T* q, size_t n) {
+                   return std::equal(p, p + n, q);});
     }
     
     // ----------
@@ -145,7 +296,18 @@ public:
      * @return  true if the lhs is less than the rhs
      */
     friend bool operator < (const my_deque& lhs, const my_deque& rhs) {
-        return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+        int order = 0;  //-1 if lhs is less, 1 if rhs is
+        zip_runs(lhs, rhs, std::min(lhs.size(), rhs.size()), [&order] (const T* p, const T* q, size_t n) {
+            for(size_t i = 0; i < n; ++i) {
+                if(p[i] < q[i])
+                    order = -1;
+                else if(q[i] < p[i])
+                    order = 1;
+                else
+                    continue;
+                return false;}
+            return true;});
+        return order ? (order < 0) : (lhs.size() < rhs.size());
     }
     
 private:
@@ -156,10 +318,49 @@ private:
     allocator_type _a;  //the standard allocator
     typename A::template rebind<T*>::other _ap; //the pointer allocator
     T** deque_root;     //root of our 2d deque
-    size_t row_count;   //number of rows
+    size_t row_count;   //number of row pointers, rows past the ends may not be allocated yet
     size_t deque_size;  //how many elements in here
     size_t begin_index; //where is the begining?
     size_t end_index;   //where is the end?
+    reclaim_sink* reclaimer; //where detached rows go, none if NULL
+    
+    /**
+     * a map of rows taken from a deque, with the values between first and last still in them
+     */
+    struct detached : reclaim_job {
+        allocator_type _a;
+        typename A::template rebind<T*>::other _ap;
+        T** root;
+        size_t count;   //slots in root
+        size_t first;   //index of the first value left to destroy
+        size_t last;    //index past the last one
+        
+        detached (const allocator_type& a, const typename A::template rebind<T*>::other& ap, T** root_, size_t count_, size_t first_, size_t last_) :
+        _a(a), _ap(ap), root(root_), count(count_), first(first_), last(last_)
+        {
+            rows = count;
+        }
+        
+        void run () {
+            for(size_t i = first; i < last; ++i)
+                _a.destroy(&root[i >> DIV_ROW_SHIFT][i & MOD_ROW_MASK]);
+            for(size_t r = 0; r < count; ++r)
+                if(root[r])
+                    _a.deallocate(root[r], INITIAL_ROW_SIZE);
+            destroy(_ap, root, root + count);
+            _ap.deallocate(root, count);
+        }
+    };
+    
+    /**
+     * hand j to the reclaimer, or run it here if the reclaimer will not take it
+     */
+    void reclaim (detached* j) {
+        if(!reclaimer->take(j)) {
+            j->run();
+            delete j;
+        }
+    }
     
     
 private:
@@ -202,6 +403,332 @@ private:
             deque_root[i] = _a.allocate(INITIAL_ROW_SIZE);
     }
     
+    /**
+     * double the row pointers, keeping the rows already in use. the new slots are empty
+     * until touch_row fills them, so pushing n values copies O(n / INITIAL_ROW_SIZE)
+     * pointers in total instead of one map copy per row
+     * @param   at_front true to add the new slots in front of the old ones
+     * @param   at_least the fewest slots to end up with, when doubling is not enough
+     */
+    void grow_map (bool at_front, size_t at_least = 0) {
+        size_t new_count = std::max(std::max(size_t(1), 2 * row_count), at_least);
+        size_t shift = at_front ? new_count - row_count : 0;
+        T** new_pointers = _ap.allocate(new_count);
+        uninitialized_fill (_ap, new_pointers, new_pointers + new_count, (T*)0);
+        std::copy(deque_root, deque_root + row_count, new_pointers + shift);
+        
+        //destroy old pointers
+        destroy(_ap, deque_root, deque_root + row_count);
+        _ap.deallocate(deque_root, row_count);
+        
+        //point to new
+        deque_root = new_pointers;
+        row_count = new_count;
+        begin_index += shift << DIV_ROW_SHIFT;
+        end_index += shift << DIV_ROW_SHIFT;
+    }
+    
+    /**
+     * allocate row r if grow_map left it empty
+     */
+    void touch_row (size_t r) {
+        if(!deque_root[r])
+            deque_root[r] = _a.allocate(INITIAL_ROW_SIZE);
+    }
+    
+    /**
+     * prefetch the row deque_prefetch::rows() after row r, or before it when back is set
+     */
+    void prefetch_from (size_t r, bool back = false) const {
+        size_t d = deque_prefetch::rows();
+        if(!d || (back && (r < d)))
+            return;
+        r = back ? r - d : r + d;
+        if((r >= row_count) || !deque_root[r])
+            return;
+        const char* p = reinterpret_cast<const char*>(deque_root[r]);
+        for(size_t b = 0; b < INITIAL_ROW_SIZE * sizeof(T); b += CACHE_LINE_SIZE)
+            __builtin_prefetch(p + b);
+    }
+    
+    /**
+     * walk the first n elements of lhs and rhs together, handing f(p, q, count) runs that
+     * are contiguous in both and prefetching ahead in both as each row starts.
+     * stops early when f returns false
+     * @return  false if f stopped the walk
+     */
+    template <typename F>
+    static bool zip_runs (const my_deque& lhs, const my_deque& rhs, size_t n, F f) {
+        size_t i = lhs.begin_index;
+        size_t j = rhs.begin_index;
+        while(n) {
+            if(!(i & MOD_ROW_MASK))
+                lhs.prefetch_from(i >> DIV_ROW_SHIFT);
+            if(!(j & MOD_ROW_MASK))
+                rhs.prefetch_from(j >> DIV_ROW_SHIFT);
+            size_t k = std::min(n, size_t(INITIAL_ROW_SIZE - std::max(i & MOD_ROW_MASK, j & MOD_ROW_MASK)));
+            if(!f(lhs.deque_root[i >> DIV_ROW_SHIFT] + (i & MOD_ROW_MASK), rhs.deque_root[j >> DIV_ROW_SHIFT] + (j & MOD_ROW_MASK), k))
+                return false;
+            i += k;
+            j += k;
+            n -= k;
+        }
+        return true;
+    }
+    
+    /**
+     * hand every contiguous run of elements, front to back, to f(pointer, count)
+     */
+    template <typename F>
+    void for_each_run (F f) const {
+        for(size_t i = begin_index; i < end_index; ) {
+            prefetch_from(i >> DIV_ROW_SHIFT);
+            size_t n = std::min(size_t(INITIAL_ROW_SIZE - (i & MOD_ROW_MASK)), end_index - i);
+            f(deque_root[i >> DIV_ROW_SHIFT] + (i & MOD_ROW_MASK), n);
+            i += n;
+        }
+    }
+    
+    /**
+     * @returns the rows in each run sort_runs sorts, SORT_RUN_BYTES of values
+     */
+    static size_t run_rows () {
+        return std::max(size_t(1), size_t(SORT_RUN_BYTES / (INITIAL_ROW_SIZE * sizeof(T))));
+    }
+    
+    /**
+     * sort each run of run_rows() rows on its own: move its values into one contiguous
+     * block, sort them there, where comparisons and swaps take no row lookups, and move
+     * them back
+     */
+    template <bool Stable, typename C>
+    void sort_runs (C less) {
+        if(deque_size < 2)
+            return;
+        size_t capacity = std::min(run_rows() << DIV_ROW_SHIFT, deque_size);
+        T* block = _a.allocate(capacity);
+        for(size_t lo = begin_index; lo < end_index; ) {
+            size_t hi = std::min(end_index, ((lo >> DIV_ROW_SHIFT) + run_rows()) << DIV_ROW_SHIFT);
+            size_t n = 0;
+            for(size_t i = lo; i < hi; i = (i | MOD_ROW_MASK) + 1) {
+                T* p = deque_root[i >> DIV_ROW_SHIFT] + (i & MOD_ROW_MASK);
+                for(T* e = p + std::min(size_t(INITIAL_ROW_SIZE - (i & MOD_ROW_MASK)), hi - i); p != e; ++p)
+                    _a.construct(block + n++, std::move(*p));
+            }
+            if(Stable)
+                std::stable_sort(block, block + n, less);
+            else
+                std::sort(block, block + n, less);
+            T* b = block;
+            for(size_t i = lo; i < hi; i = (i | MOD_ROW_MASK) + 1) {
+                size_t k = std::min(size_t(INITIAL_ROW_SIZE - (i & MOD_ROW_MASK)), hi - i);
+                std::move(b, b + k, deque_root[i >> DIV_ROW_SHIFT] + (i & MOD_ROW_MASK));
+                b += k;
+            }
+            destroy(_a, block, block + n);
+            lo = hi;
+        }
+        _a.deallocate(block, capacity);
+    }
+    
+    /**
+     * merge the runs sort_runs left with a loser tree, a comparison per level per value.
+     * values are moved into fresh rows, and each row a run is done with is reused for the
+     * output, so the merge needs about a spare row per run instead of a second deque.
+     * of equal values the one from the earlier run goes first, which keeps stable_sort stable
+     */
+    template <bool Stable, typename C>
+    void merge_runs (C less) {
+        size_t first = begin_index >> DIV_ROW_SHIFT;
+        size_t rows = ((end_index + MOD_ROW_MASK) >> DIV_ROW_SHIFT) - first;
+        size_t g = run_rows();
+        size_t k = (rows + g - 1) / g;
+        if(k < 2)
+            return;
+        size_t leaves = 1;
+        while(leaves < k)
+            leaves <<= 1;
+        
+        struct run {
+            T* next;        //the next value, NULL once the run is done
+            T* row_end;     //past the run's last value in next's row
+            size_t row;     //next's row
+            size_t stop;    //past the run's last index
+        };
+        std::vector<run> runs(leaves);
+        for(size_t j = 0; j < leaves; ++j) {
+            size_t at = std::min(end_index, std::max(begin_index, (first + j * g) << DIV_ROW_SHIFT));
+            run& x = runs[j];
+            x.stop = std::min(end_index, (first + (j + 1) * g) << DIV_ROW_SHIFT);
+            x.row = at >> DIV_ROW_SHIFT;
+            x.next = (at < x.stop) ? deque_root[x.row] + (at & MOD_ROW_MASK) : 0;
+            x.row_end = x.next + (std::min(x.stop, (x.row + 1) << DIV_ROW_SHIFT) - at);
+        }
+        std::vector<T*> spare;                  //rows the runs are done with
+        std::vector<T*> fresh(rows);            //the sorted rows
+        
+        auto beats = [&] (size_t a, size_t b) -> bool {
+            const T* p = runs[a].next;
+            const T* q = runs[b].next;
+            if(!p)
+                return false;
+            if(!q)
+                return true;
+            if(!Stable)
+                return less(*p, *q);
+            return (a < b) ? !less(*q, *p) : less(*p, *q);};
+        
+        std::vector<size_t> loser(leaves);
+        std::vector<size_t> winner(2 * leaves);
+        for(size_t j = 0; j < leaves; ++j)
+            winner[leaves + j] = j;
+        for(size_t n = leaves - 1; n; --n) {
+            size_t a = winner[2 * n];
+            size_t b = winner[2 * n + 1];
+            bool x = beats(a, b);
+            winner[n] = x ? a : b;
+            loser[n] = x ? b : a;
+        }
+        
+        size_t w = winner[1];
+        T* out = 0;
+        T* out_end = 0;
+        for(size_t o = begin_index; o < end_index; ++o) {
+            if(out == out_end) {
+                T* row = spare.empty() ? _a.allocate(INITIAL_ROW_SIZE) : spare.back();
+                if(!spare.empty())
+                    spare.pop_back();
+                fresh[(o >> DIV_ROW_SHIFT) - first] = row;
+                out = row + (o & MOD_ROW_MASK);
+                out_end = row + INITIAL_ROW_SIZE;
+            }
+            run& x = runs[w];
+            _a.construct(out++, std::move(*x.next));
+            _a.destroy(x.next);
+            if(++x.next == x.row_end) {
+                spare.push_back(deque_root[x.row]);
+                size_t at = ++x.row << DIV_ROW_SHIFT;
+                if(at < x.stop) {
+                    prefetch_from(x.row);
+                    x.next = deque_root[x.row];
+                    x.row_end = x.next + std::min(size_t(INITIAL_ROW_SIZE), x.stop - at);
+                }
+                else
+                    x.next = 0;
+            }
+            
+            for(size_t n = (leaves + w) >> 1; n; n >>= 1)
+                if(beats(loser[n], w))
+                    std::swap(loser[n], w);
+        }
+        
+        std::copy(fresh.begin(), fresh.end(), deque_root + first);
+        for(size_t r = 0; r < spare.size(); ++r)
+            _a.deallocate(spare[r], INITIAL_ROW_SIZE);
+    }
+    
+    /**
+     * fill in a deque_io header for this deque
+     */
+    void write_header (char* h) const {
+        unsigned version = DEQUE_IO_VERSION;
+        unsigned width = sizeof(T);
+        unsigned reserved = 0;
+        unsigned long long count = deque_size;
+        std::memcpy(h, DEQUE_IO_MAGIC, 4);
+        std::memcpy(h + 4, &version, 4);
+        std::memcpy(h + 8, &width, 4);
+        std::memcpy(h + 12, &reserved, 4);
+        std::memcpy(h + 16, &count, 8);
+    }
+    
+    /**
+     * check a deque_io header, empty this deque and allocate every row it will need
+     * @return  the element count
+     * @throws  runtime_error if the header is not for a my_deque of this T
+     */
+    size_t read_header (const char* h) {
+        unsigned version, width;
+        unsigned long long count;
+        std::memcpy(&version, h + 4, 4);
+        std::memcpy(&width, h + 8, 4);
+        std::memcpy(&count, h + 16, 8);
+        if(std::memcmp(h, DEQUE_IO_MAGIC, 4) || (version != DEQUE_IO_VERSION) || (width != sizeof(T)))
+            throw std::runtime_error("deserialize bad header");
+        
+        if(deque_root)
+            clear();
+        allocate_rows(count);
+        begin_index = 0;
+        end_index = 0;
+        deque_size = 0;
+        return count;
+    }
+    
+    /**
+     * mark the next n elements as read in
+     */
+    void loaded (size_t n) {
+        end_index += n;
+        deque_size += n;
+    }
+    
+    void serialize (std::ostream& out, std::true_type) const {
+        for_each_run([&out] (const T* p, size_t n) {
+            out.write(reinterpret_cast<const char*>(p), n * sizeof(T));});
+    }
+    
+    void serialize (std::ostream& out, std::false_type) const {
+        for_each_run([&out] (const T* p, size_t n) {
+            for(size_t i = 0; i < n; ++i)
+                deque_io<T>::write(out, p[i]);});
+    }
+    
+    void deserialize (std::istream& in, size_t count, std::true_type) {
+        for(size_t r = 0; count; ++r) {
+            size_t n = std::min(size_t(INITIAL_ROW_SIZE), count);
+            if(!in.read(reinterpret_cast<char*>(deque_root[r]), n * sizeof(T)))
+                throw std::runtime_error("deserialize short read");
+            loaded(n);
+            count -= n;
+        }
+    }
+    
+    void deserialize (std::istream& in, size_t count, std::false_type) {
+        for(; count; --count) {
+            T v = deque_io<T>::read(in);
+            if(!in)
+                throw std::runtime_error("deserialize short read");
+            _a.construct(&deque_root[end_index >> DIV_ROW_SHIFT][end_index & MOD_ROW_MASK], v);
+            loaded(1);
+        }
+    }
+    
+    /**
+     * run writev or readv over v[0, n) until every byte is moved
+     * @return  false on an error or an early end of file
+     */
+    template <typename F>
+    static bool move_all (F f, int fd, struct iovec* v, int n) {
+        while(n) {
+            ssize_t k = f(fd, v, n);
+            if(k < 0 && errno == EINTR)
+                continue;
+            if(k <= 0)
+                return false;
+            while(n && size_t(k) >= v->iov_len) {
+                k -= v->iov_len;
+                ++v;
+                --n;
+            }
+            if(n) {
+                v->iov_base = static_cast<char*>(v->iov_base) + k;
+                v->iov_len -= k;
+            }
+        }
+        return true;
+    }
+    
 public:
     // --------
     // iterator
@@ -272,6 +799,16 @@ public:
             return lhs -= rhs;
         }
         
+        /**
+         * the distance between two iterators into the same deque
+         * @param   lhs the later iterator
+         * @param   rhs the earlier iterator
+         * @return  how many values lie from rhs up to lhs
+         */
+        friend difference_type operator - (const iterator& lhs, const iterator& rhs) {
+            return difference_type(lhs.index - rhs.index);
+        }
+        
     private:
         // ----
         // data
@@ -340,11 +877,14 @@ public:
         // -----------
         
         /**
-         * increment (pre) this iterator by one. the iterator will point to the next value
+         * increment (pre) this iterator by one. the iterator will point to the next value.
+         * stepping into a new row prefetches the row deque_prefetch::rows() further on
          * @returns iterator with its NEW value
          */
         iterator& operator ++ () {
             ++index;
+            if(!(index & MOD_ROW_MASK))
+                owner->prefetch_from(index >> DIV_ROW_SHIFT);
             assert(valid());
             return *this;
         }
@@ -370,6 +910,8 @@ public:
          */
         iterator& operator -- () {
             --index;
+            if((index & MOD_ROW_MASK) == MOD_ROW_MASK)
+                owner->prefetch_from(index >> DIV_ROW_SHIFT, true);
             assert(valid());
             return *this;
         }
@@ -486,6 +1028,16 @@ public:
             return lhs -= rhs;
         }
         
+        /**
+         * the distance between two iterators into the same deque
+         * @param   lhs the later iterator
+         * @param   rhs the earlier iterator
+         * @return  how many values lie from rhs up to lhs
+         */
+        friend difference_type operator - (const const_iterator& lhs, const const_iterator& rhs) {
+            return difference_type(lhs.index - rhs.index);
+        }
+        
     private:
         // ----
         // data
@@ -556,11 +1108,14 @@ public:
         // -----------
         
         /**
-         * increment (pre) this iterator by one. the iterator will point to the next value
+         * increment (pre) this iterator by one. the iterator will point to the next value.
+         * stepping into a new row prefetches the row deque_prefetch::rows() further on
          * @returns iterator with its NEW value
          */
         const_iterator& operator ++ () {
             ++index;
+            if(!(index & MOD_ROW_MASK))
+                owner->prefetch_from(index >> DIV_ROW_SHIFT);
             assert(valid());
             return *this;
         }
@@ -586,6 +1141,8 @@ public:
          */
         const_iterator& operator -- () {
             --index;
+            if((index & MOD_ROW_MASK) == MOD_ROW_MASK)
+                owner->prefetch_from(index >> DIV_ROW_SHIFT, true);
             assert(valid());
             return *this;
         }
@@ -645,7 +1202,7 @@ public:
      * @return  the new deque
      */
     explicit my_deque (const allocator_type& a = allocator_type()) :
-    _a(a)
+    _a(a), _ap(a), reclaimer(NULL)
     {
         allocate_rows(INITIAL_ROW_SIZE);
         deque_size = 0;
@@ -662,7 +1219,7 @@ public:
      * @return  the new deque
      */
     explicit my_deque (size_type s, const_reference v = value_type(), const allocator_type& a = allocator_type()) :
-    _a(a)
+    _a(a), _ap(a), reclaimer(NULL)
     {
         allocate_rows(s);
         deque_size = s;
@@ -680,7 +1237,7 @@ public:
      * @return  the new deque
      */
     my_deque (const my_deque& that) :
-    _a(that._a)
+    _a(that._a), _ap(that._ap), reclaimer(NULL)
     {
         allocate_rows(that.deque_size);
         
@@ -692,6 +1249,28 @@ public:
         assert(valid());
     }
     
+    /**
+     * create a new deque that takes over the rows of that, leaving that empty
+     * @param   that the deque to be taken from
+     * @return  the new deque
+     */
+    my_deque (my_deque&& that) :
+    _a(that._a), _ap(that._ap), reclaimer(that.reclaimer)
+    {
+        deque_root = that.deque_root;
+        row_count = that.row_count;
+        deque_size = that.deque_size;
+        begin_index = that.begin_index;
+        end_index = that.end_index;
+        
+        that.deque_root = NULL;
+        that.row_count = 0;
+        that.deque_size = 0;
+        that.begin_index = INITIAL_ROW_SIZE >> 1;
+        that.end_index = that.begin_index;
+        assert(valid());
+    }
+    
     // ----------
     // destructor
     // ----------
@@ -733,9 +1312,9 @@ public:
             clear();
             allocate_rows(rhs.size());
             begin_index = 0;
+            end_index = rhs.size(); //before the copy, so iterators up to end() are in range
             uninitialized_copy(_a, rhs.begin(), rhs.end(), begin());
             deque_size = rhs.size();
-            end_index = deque_size;
         }
         
         
@@ -835,6 +1414,60 @@ public:
         return const_cast<my_deque*>(this)->back();
     }
     
+    // ------
+    // append
+    // ------
+    
+    /**
+     * move every value of other onto the back of this deque, leaving other empty.
+     * when this deque's end and other's begin sit at the same place in their rows, only the
+     * values of other's first partial row are moved and its other rows change hands by
+     * pointer, O(rows). otherwise the smaller deque is copied onto the larger one
+     * @param other the deque to take the values of
+     */
+    void append (my_deque&& other) {
+        if((this == &other) || other.empty())
+            return;
+        if(empty()) {
+            swap(other);
+            return;
+        }
+        if(!(_a == other._a) || ((end_index ^ other.begin_index) & MOD_ROW_MASK)) {
+            if((size() >= other.size()) || !(_a == other._a))
+                for(iterator it = other.begin(); it != other.end(); ++it)
+                    push_back(*it);
+            else {
+                for(iterator it = end(); it != begin(); )
+                    other.push_front(*--it);
+                swap(other);
+            }
+            other.clear();
+            return;
+        }
+        
+        //top up our last row from the front of other, after which both are on row boundaries
+        while((end_index & MOD_ROW_MASK) && !other.empty()) {
+            _a.construct(&deque_root[end_index >> DIV_ROW_SHIFT][end_index & MOD_ROW_MASK], std::move(other.front()));
+            ++end_index;
+            ++deque_size;
+            other.pop_front();
+        }
+        if(other.empty())
+            return;
+        
+        size_t from = other.begin_index >> DIV_ROW_SHIFT;
+        size_t rows = ((other.end_index + MOD_ROW_MASK) >> DIV_ROW_SHIFT) - from;
+        if(row_count - (end_index >> DIV_ROW_SHIFT) < rows)
+            grow_map(false, (end_index >> DIV_ROW_SHIFT) + rows);
+        for(size_t r = 0; r < rows; ++r) //our spare rows, if any, go to other to be freed
+            std::swap(deque_root[(end_index >> DIV_ROW_SHIFT) + r], other.deque_root[from + r]);
+        end_index += other.deque_size;
+        deque_size += other.deque_size;
+        other.end_index = other.begin_index;
+        other.deque_size = 0;
+        assert(valid());
+    }
+    
     
     // -----
     // clear
@@ -844,12 +1477,23 @@ public:
      * clears this deque, destroying all members and deallocating all memory
      */
     void clear () {
+        if(reclaimer && deque_root) { //hand the whole map over in O(1)
+            reclaim(new detached(_a, _ap, deque_root, row_count, begin_index, end_index));
+            deque_size = 0;
+            deque_root = NULL;
+            row_count = 0;
+            begin_index = INITIAL_ROW_SIZE >> 1;
+            end_index = begin_index;
+            return;
+        }
+        
         //destroy the elements
         destroy(_a, begin(), end());
         
         //deallocate elements
         for(size_t i = 0; i < row_count; ++i)
-            _a.deallocate(deque_root[i], INITIAL_ROW_SIZE);
+            if(deque_root[i])
+                _a.deallocate(deque_root[i], INITIAL_ROW_SIZE);
         
         //destroy/deallocate the pointers
         destroy(_ap, deque_root, deque_root + row_count);
@@ -953,7 +1597,7 @@ public:
             push_front(ins);
             return spot;
         }
-        if(((end_index & MOD_ROW_MASK) == 0) && (end_index >> DIV_ROW_SHIFT == row_count)) {
+        if((end_index & MOD_ROW_MASK) == 0) {
             //push empty T to allocate a new row
             push_back(T());
             --deque_size;
@@ -1002,6 +1646,50 @@ public:
         assert(valid());
     }
     
+    /**
+     * removes (destroys) the n values at the front of the deque. with a reclaimer, the
+     * rows they fill are handed to it, O(rows), and only the values sharing the new
+     * front's row are destroyed here
+     * @param n how many values to remove, at most size()
+     */
+    void pop_front_n (size_type n) {
+        assert(n <= deque_size);
+        size_t stop = begin_index + n;
+        size_t first = begin_index >> DIV_ROW_SHIFT;
+        size_t rows = (stop >> DIV_ROW_SHIFT) - first; //rows left with no values
+        if(reclaimer && rows) {
+            T** root = _ap.allocate(rows);
+            uninitialized_fill (_ap, root, root + rows, (T*)0);
+            for(size_t r = 0; r < rows; ++r) {
+                root[r] = deque_root[first + r];
+                deque_root[first + r] = NULL;    //touch_row allocates it again if needed
+            }
+            reclaim(new detached(_a, _ap, root, rows, begin_index & MOD_ROW_MASK, rows << DIV_ROW_SHIFT));
+            begin_index = (first + rows) << DIV_ROW_SHIFT;
+        }
+        for(; begin_index < stop; ++begin_index)
+            _a.destroy(&deque_root[begin_index >> DIV_ROW_SHIFT][begin_index & MOD_ROW_MASK]);
+        deque_size -= n;
+        assert(valid());
+    }
+    
+    // -------
+    // prepend
+    // -------
+    
+    /**
+     * move every value of other onto the front of this deque, leaving other empty.
+     * O(rows) when other's end and this deque's begin sit at the same place in their rows,
+     * the same way as append
+     * @param other the deque to take the values of
+     */
+    void prepend (my_deque&& other) {
+        if(this == &other)
+            return;
+        other.append(std::move(*this));
+        swap(other);
+    }
+    
     // ----
     // push
     // ----
@@ -1013,22 +1701,10 @@ public:
     void push_back (const_reference val) {
         if(!deque_root)
             allocate_rows(INITIAL_ROW_SIZE);
-        if(((end_index & MOD_ROW_MASK) == 0) && (end_index >> DIV_ROW_SHIFT == row_count)) { //row full
-            //add new row pointer
-            T** new_pointers = _ap.allocate(row_count + 1);
-            uninitialized_copy (_ap, deque_root, deque_root + row_count, new_pointers);
-            
-            //destroy old pointers
-            _ap.deallocate(deque_root, row_count);
-            
-            //point to new
-            deque_root = new_pointers;
-            
-            ++row_count;
-            
-            //allocate new row
-            deque_root[row_count - 1] = _a.allocate(INITIAL_ROW_SIZE);
-            
+        if((end_index & MOD_ROW_MASK) == 0) { //row full
+            if(end_index >> DIV_ROW_SHIFT == row_count)
+                grow_map(false);
+            touch_row(end_index >> DIV_ROW_SHIFT);
         }
         _a.construct(&deque_root[end_index >> DIV_ROW_SHIFT][end_index & MOD_ROW_MASK], val);
         ++end_index;
@@ -1045,22 +1721,10 @@ public:
     void push_front (const_reference val) {
         if(!deque_root)
             allocate_rows(INITIAL_ROW_SIZE);
-        if(begin_index == 0) { //add row
-            //add new row pointer
-            T** new_pointers = _ap.allocate(row_count + 1);
-            uninitialized_copy (_ap, deque_root, deque_root + row_count, new_pointers + 1);
-            
-            //destroy old pointers
-            _ap.deallocate(deque_root, row_count);
-            
-            //point to new
-            deque_root = new_pointers;
-            ++row_count;
-            
-            //allocate new row
-            deque_root[0] = _a.allocate(INITIAL_ROW_SIZE);
-            begin_index += INITIAL_ROW_SIZE;
-            end_index += INITIAL_ROW_SIZE;
+        if((begin_index & MOD_ROW_MASK) == 0) { //row full
+            if(begin_index == 0)
+                grow_map(true);
+            touch_row((begin_index >> DIV_ROW_SHIFT) - 1);
         }
         
         --begin_index;
@@ -1092,6 +1756,100 @@ public:
         assert(valid());
     }
     
+    // ---------
+    // serialize
+    // ---------
+    
+    /**
+     * write a header and then every element, a row at a time for trivially copyable T
+     * and through deque_io<T>::write otherwise
+     * @param out the stream to write to
+     */
+    void serialize (std::ostream& out) const {
+        char h[DEQUE_IO_HEADER];
+        write_header(h);
+        out.write(h, DEQUE_IO_HEADER);
+        serialize(out, std::integral_constant<bool, deque_io<T>::bulk>());
+    }
+    
+    /**
+     * write a header and then every row, DEQUE_IO_BATCH rows per writev
+     * @param fd the file descriptor to write to
+     * @throws runtime_error if a write fails
+     */
+    void serialize (int fd) const {
+        static_assert(deque_io<T>::bulk, "serialize(int) needs a trivially copyable T");
+        char h[DEQUE_IO_HEADER];
+        write_header(h);
+        struct iovec v[DEQUE_IO_BATCH];
+        v[0].iov_base = h;
+        v[0].iov_len = DEQUE_IO_HEADER;
+        int n = 1;
+        bool ok = true;
+        for_each_run([&] (const T* p, size_t k) {
+            v[n].iov_base = const_cast<T*>(p);
+            v[n].iov_len = k * sizeof(T);
+            if(++n == DEQUE_IO_BATCH) {
+                ok = ok && move_all(::writev, fd, v, n);
+                n = 0;
+            }});
+        if(!ok || !move_all(::writev, fd, v, n))
+            throw std::runtime_error("serialize write failed");
+    }
+    
+    // -----------
+    // deserialize
+    // -----------
+    
+    /**
+     * replace the contents with a deque written by serialize. every row is allocated up
+     * front and read into directly
+     * @param in the stream to read from
+     * @throws runtime_error if the header does not match or the stream ends early, leaving
+     *         the elements read so far
+     */
+    void deserialize (std::istream& in) {
+        char h[DEQUE_IO_HEADER];
+        if(!in.read(h, DEQUE_IO_HEADER))
+            throw std::runtime_error("deserialize short read");
+        size_t count = read_header(h);
+        deserialize(in, count, std::integral_constant<bool, deque_io<T>::bulk>());
+        assert(valid());
+    }
+    
+    /**
+     * replace the contents with a deque written by serialize, DEQUE_IO_BATCH rows per readv
+     * @param fd the file descriptor to read from
+     * @throws runtime_error if the header does not match or the file ends early, leaving
+     *         the rows read so far
+     */
+    void deserialize (int fd) {
+        static_assert(deque_io<T>::bulk, "deserialize(int) needs a trivially copyable T");
+        char h[DEQUE_IO_HEADER];
+        struct iovec v[DEQUE_IO_BATCH];
+        v[0].iov_base = h;
+        v[0].iov_len = DEQUE_IO_HEADER;
+        if(!move_all(::readv, fd, v, 1))
+            throw std::runtime_error("deserialize short read");
+        size_t count = read_header(h);
+        
+        for(size_t r = 0; count; ) {
+            int n = 0;
+            size_t batch = 0;
+            for(; n < DEQUE_IO_BATCH && count; ++n, ++r) {
+                size_t k = std::min(size_t(INITIAL_ROW_SIZE), count);
+                v[n].iov_base = deque_root[r];
+                v[n].iov_len = k * sizeof(T);
+                batch += k;
+                count -= k;
+            }
+            if(!move_all(::readv, fd, v, n))
+                throw std::runtime_error("deserialize short read");
+            loaded(batch);
+        }
+        assert(valid());
+    }
+    
     // ----
     // size
     // ----
@@ -1104,12 +1862,155 @@ public:
         return deque_size;
     }
     
+    // -------------
+    // set_reclaimer
+    // -------------
+    
+    /**
+     * opt in to deferred destruction: from now on clear(), the destructor and pop_front_n
+     * hand the rows they empty to r instead of destroying the values here.
+     * r must outlive this deque. copies of this deque do not share it
+     * @param r the reclaimer to use, NULL to destroy values here again
+     */
+    void set_reclaimer (reclaim_sink* r) {
+        reclaimer = r;
+    }
+    
+    /**
+     * @returns the reclaimer in use, NULL if none
+     */
+    reclaim_sink* get_reclaimer () const {
+        return reclaimer;
+    }
+    
+    // -------------
+    // segment_count
+    // -------------
+    
+    /**
+     * @returns how many contiguous runs the values are split into, one per row touched
+     */
+    size_type segment_count () const {
+        if(begin_index == end_index)
+            return 0;
+        return ((end_index - 1) >> DIV_ROW_SHIFT) - (begin_index >> DIV_ROW_SHIFT) + 1;
+    }
+    
+    // -------
+    // segment
+    // -------
+    
+    /**
+     * get one contiguous run of values
+     * @param s the run, 0 <= s < segment_count()
+     * @return the run's address and length
+     */
+    row_span<T> segment (size_type s) {
+        size_t r = (begin_index >> DIV_ROW_SHIFT) + s;
+        size_t lo = std::max(begin_index, r << DIV_ROW_SHIFT);
+        size_t hi = std::min(end_index, (r + 1) << DIV_ROW_SHIFT);
+        row_span<T> x = {deque_root[r] + (lo & MOD_ROW_MASK), hi - lo};
+        return x;
+    }
+    
+    row_span<const T> segment (size_type s) const {
+        row_span<T> x = const_cast<my_deque*>(this)->segment(s);
+        row_span<const T> y = {x.data, x.length};
+        return y;
+    }
+    
+    // --------
+    // split_at
+    // --------
+    
+    /**
+     * move the values from pos on into a new deque. rows past pos's row change hands by
+     * pointer and only the values sharing pos's row are moved, O(rows)
+     * @param pos the index of the first value to split off, at most size()
+     * @return a deque holding the values that were at pos and after it
+     */
+    my_deque split_at (size_type pos) {
+        assert(pos <= deque_size);
+        my_deque x(_a);
+        size_t t = deque_size - pos;
+        if(!t)
+            return x;
+        
+        size_t p = begin_index + pos;
+        size_t first = p >> DIV_ROW_SHIFT;
+        size_t rows = ((end_index + MOD_ROW_MASK) >> DIV_ROW_SHIFT) - first;
+        if(x.row_count < rows)
+            x.grow_map(false, rows);
+        x.begin_index = p & MOD_ROW_MASK; //same place in the row, so whole rows can move
+        x.end_index = x.begin_index + t;
+        
+        size_t r = 0;
+        if(p & MOD_ROW_MASK) { //pos's row stays, its values from pos on are moved
+            x.touch_row(0);
+            size_t stop = std::min(end_index, (first + 1) << DIV_ROW_SHIFT);
+            for(size_t i = p; i < stop; ++i) {
+                T* v = &deque_root[first][i & MOD_ROW_MASK];
+                x._a.construct(&x.deque_root[0][i & MOD_ROW_MASK], std::move(*v));
+                _a.destroy(v);
+            }
+            r = 1;
+        }
+        for(; r < rows; ++r)
+            std::swap(x.deque_root[r], deque_root[first + r]);
+        x.deque_size = t;
+        end_index = p;
+        deque_size = pos;
+        assert(valid());
+        return x;
+    }
+    
     // ----
-    // swap
+    // sort
     // ----
     
     /**
-     * swap this deque's values with another
+     * sort the values, O(n log n). my_deque's iterators are bidirectional, so std::sort
+     * does not take them; this sorts runs of SORT_RUN_BYTES in one contiguous block each and
+     * then merges the runs through the rows with a loser tree. equal values may be reordered.
+     * less must not throw, and neither may T's move constructor or move assignment
+     * @param less the order to sort by
+     */
+    template <typename C>
+    void sort (C less) {
+        sort_runs<false>(less);
+        merge_runs<false>(less);
+        assert(valid());
+    }
+    
+    void sort () {
+        sort(std::less<T>());
+    }
+    
+    // -----------
+    // stable_sort
+    // -----------
+    
+    /**
+     * sort the values like sort, keeping equal values in the order they were in
+     * @param less the order to sort by
+     */
+    template <typename C>
+    void stable_sort (C less) {
+        sort_runs<true>(less);
+        merge_runs<true>(less);
+        assert(valid());
+    }
+    
+    void stable_sort () {
+        stable_sort(std::less<T>());
+    }
+    
+    // ----
+    // swap
+    // ----
+    
+    /**
+     * swap this deque's values with another
      * @param other the other deque to be swapped with
      */
     void swap (my_deque& other) {
@@ -1129,4 +2030,1046 @@ public:
     }
 };
 
+// ---------------
+// my_deque<bool>
+// ---------------
+
+/**
+ * A packed my_deque of flags.
+ * Flags are stored WORD_BITS to a word and INITIAL_ROW_SIZE words to a row, so a row holds
+ * 1 << (DIV_ROW_SHIFT + DIV_WORD_SHIFT) flags where the generic deque would hold INITIAL_ROW_SIZE.
+ * Elements are reached through a proxy reference. Rows that pop_front leaves behind are freed,
+ * and the row map is recentered instead of grown when a queue simply slides along it.
+ */
+template <typename A>
+class my_deque<bool, A> {
+public:
+    // --------
+    // typedefs
+    // --------
+
+    typedef A                                        allocator_type;
+    typedef bool                                     value_type;
+
+    typedef typename allocator_type::size_type       size_type;
+    typedef typename allocator_type::difference_type difference_type;
+
+    typedef unsigned long long                       word_type;
+
+    class reference;
+    class iterator;
+    class const_iterator;
+
+    typedef bool                                     const_reference;
+    typedef iterator                                 pointer;
+    typedef const_iterator                           const_pointer;
+
+public:
+    // -----------
+    // operator ==
+    // -----------
+
+    /**
+     * checks to see if the lhs == rhs
+     * @param   lhs the left hand side in question
+     * @param   rhs the right hand side in question
+     * @return  true if the lhs and rhs have same value and number of items
+     */
+    friend bool operator == (const my_deque& lhs, const my_deque& rhs) {
+        if(lhs.size() != rhs.size())
+            return false;
+        for(size_type i = 0; i < lhs.size(); i += WORD_BITS) {
+            size_type take = std::min<size_type>(WORD_BITS, lhs.size() - i);
+            if(lhs.get_bits(lhs.begin_index + i, take) != rhs.get_bits(rhs.begin_index + i, take))
+                return false;
+        }
+        return true;
+    }
+
+    // ----------
+    // operator <
+    // ----------
+
+    /**
+     * checks to see if the lhs < rhs
+     * @param   lhs the left hand side in question
+     * @param   rhs the right hand side in question
+     * @return  true if the lhs is less than the rhs
+     */
+    friend bool operator < (const my_deque& lhs, const my_deque& rhs) {
+        return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+
+private:
+    // ----
+    // data
+    // ----
+
+    typename A::template rebind<word_type>::other  _w;  //the word allocator
+    typename A::template rebind<word_type*>::other _ap; //the row pointer allocator
+    word_type** deque_root; //root of our 2d deque, rows may be 0 outside [begin, end)
+    size_t row_count;       //number of row slots in the map
+    size_t begin_index;     //bit where the deque begins
+    size_t end_index;       //bit past the end
+
+private:
+    // -----
+    // valid
+    // -----
+
+    bool valid () const {
+        return (begin_index <= end_index) && (end_index <= (row_count << ROW_BIT_SHIFT));
+    }
+
+    /**
+     * @param   n a count of bits, 0 < n <= WORD_BITS
+     * @return  a word with the low n bits set
+     */
+    static word_type low_mask (size_t n) {
+        return n == WORD_BITS ? ~0ULL : (1ULL << n) - 1;
+    }
+
+    /**
+     * @param   w a word index into the map, its row must be allocated
+     * @return  the word
+     */
+    word_type& word_at (size_t w) const {
+        return deque_root[w >> DIV_ROW_SHIFT][w & MOD_ROW_MASK];
+    }
+
+    /**
+     * make sure the row holding bit i exists
+     * @param   i an absolute bit index inside the map
+     */
+    void touch_row (size_t i) {
+        word_type*& row = deque_root[i >> ROW_BIT_SHIFT];
+        if(!row)
+            row = _w.allocate(INITIAL_ROW_SIZE);
+    }
+
+    /**
+     * read up to WORD_BITS consecutive flags
+     * @param   i the absolute bit to start at
+     * @param   take how many flags to read, 0 < take <= WORD_BITS
+     * @return  the flags, bit 0 holding flag i
+     */
+    word_type get_bits (size_t i, size_t take) const {
+        size_t off = i & MOD_WORD_MASK;
+        word_type x = word_at(i >> DIV_WORD_SHIFT) >> off;
+        if(off + take > WORD_BITS)
+            x |= word_at((i >> DIV_WORD_SHIFT) + 1) << (WORD_BITS - off);
+        return x & low_mask(take);
+    }
+
+    /**
+     * write up to WORD_BITS consecutive flags, the rows must be allocated
+     * @param   i the absolute bit to start at
+     * @param   take how many flags to write, 0 < take <= WORD_BITS
+     * @param   bits the flags, bit 0 going to flag i
+     */
+    void set_bits (size_t i, size_t take, word_type bits) {
+        size_t off = i & MOD_WORD_MASK;
+        word_type m = low_mask(take);
+        word_type& lo = word_at(i >> DIV_WORD_SHIFT);
+        lo = (lo & ~(m << off)) | ((bits & m) << off);
+        if(off + take > WORD_BITS) {
+            word_type m2 = low_mask(off + take - WORD_BITS);
+            word_type& hi = word_at((i >> DIV_WORD_SHIFT) + 1);
+            hi = (hi & ~m2) | ((bits >> (WORD_BITS - off)) & m2);
+        }
+    }
+
+    /**
+     * allocate a map of r row slots, all 0
+     * @param   r the number of row slots
+     */
+    void allocate_map (size_t r) {
+        row_count = r;
+        deque_root = _ap.allocate(row_count);
+        std::fill(deque_root, deque_root + row_count, (word_type*)0);
+    }
+
+    /**
+     * free every row and the map
+     */
+    void free_map () {
+        for(size_t i = 0; i < row_count; ++i)
+            if(deque_root[i])
+                _w.deallocate(deque_root[i], INITIAL_ROW_SIZE);
+        _ap.deallocate(deque_root, row_count);
+        deque_root = NULL;
+        row_count = 0;
+    }
+
+    /**
+     * make room for add more rows at one end of the map. when the live rows take up
+     * less than half of the map they are slid to the middle, otherwise the map doubles
+     * @param   add the number of row slots needed past the live rows
+     * @param   at_front true to make the room in front of begin, false after end
+     */
+    void reserve_rows (size_t add, bool at_front) {
+        size_t first = begin_index >> ROW_BIT_SHIFT;
+        size_t last = (end_index + ROW_BITS - 1) >> ROW_BIT_SHIFT;
+        if(last < first + 1)
+            last = first + 1;
+        size_t live = last - first;
+        size_t need = live + add;
+
+        //rows kept alive after pop_back are not worth carrying along
+        for(size_t i = 0; i < row_count; ++i)
+            if((i < first || i >= last) && deque_root[i]) {
+                _w.deallocate(deque_root[i], INITIAL_ROW_SIZE);
+                deque_root[i] = NULL;
+            }
+
+        size_t new_count = row_count;
+        if(2 * need > row_count)
+            new_count = std::max(2 * row_count, 2 * need);
+        size_t new_first = (new_count - need) / 2 + (at_front ? add : 0);
+
+        if(new_count == row_count && new_first > first) {
+            std::copy_backward(deque_root + first, deque_root + last, deque_root + new_first + live);
+            std::fill(deque_root + first, deque_root + std::min(new_first, last), (word_type*)0);
+        }
+        else if(new_count == row_count && new_first < first) {
+            std::copy(deque_root + first, deque_root + last, deque_root + new_first);
+            std::fill(deque_root + std::max(new_first + live, first), deque_root + last, (word_type*)0);
+        }
+        else if(new_count != row_count) {
+            word_type** new_root = _ap.allocate(new_count);
+            std::fill(new_root, new_root + new_count, (word_type*)0);
+            std::copy(deque_root + first, deque_root + last, new_root + new_first);
+            _ap.deallocate(deque_root, row_count);
+            deque_root = new_root;
+            row_count = new_count;
+        }
+
+        size_t shift = (new_first << ROW_BIT_SHIFT) - (first << ROW_BIT_SHIFT);
+        begin_index += shift;
+        end_index += shift;
+        assert(valid());
+    }
+
+    /**
+     * make sure n more flags fit after end_index
+     * @param   n the number of flags about to be pushed
+     */
+    void reserve_back (size_t n) {
+        if(end_index + n <= (row_count << ROW_BIT_SHIFT))
+            return;
+        size_t first = begin_index >> ROW_BIT_SHIFT;
+        size_t live = std::max(first + 1, (end_index + ROW_BITS - 1) >> ROW_BIT_SHIFT) - first;
+        size_t wanted = ((end_index + n - 1 - (first << ROW_BIT_SHIFT)) >> ROW_BIT_SHIFT) + 1;
+        reserve_rows(wanted - live, false);
+    }
+
+    /**
+     * copy the flags of that onto the back of this one, rows allocated as needed
+     * @param   that the flags to copy
+     */
+    void append_bits (const my_deque& that) {
+        size_type n = that.size();
+        reserve_back(n);
+        for(size_type i = 0; i < n; i += WORD_BITS) {
+            size_type take = std::min<size_type>(WORD_BITS, n - i);
+            touch_row(end_index + i);
+            touch_row(end_index + i + take - 1);
+            set_bits(end_index + i, take, that.get_bits(that.begin_index + i, take));
+        }
+        end_index += n;
+    }
+
+public:
+    // ---------
+    // reference
+    // ---------
+
+    /**
+     * A proxy for one flag: converts to bool, assigns from bool.
+     */
+    class reference {
+        friend class my_deque;
+
+    private:
+        word_type* word;
+        word_type  mask;
+
+        reference (word_type* word_, word_type mask_) :
+        word(word_), mask(mask_)
+        {}
+
+    public:
+        /**
+         * @returns the value of the flag
+         */
+        operator bool () const {
+            return (*word & mask) != 0;
+        }
+
+        /**
+         * set the flag
+         * @param v the new value
+         * @returns this
+         */
+        reference& operator = (bool v) {
+            if(v)
+                *word |= mask;
+            else
+                *word &= ~mask;
+            return *this;
+        }
+
+        /**
+         * set the flag to the value of another flag
+         * @param that the flag to copy
+         * @returns this
+         */
+        reference& operator = (const reference& that) {
+            return *this = static_cast<bool>(that);
+        }
+
+        /**
+         * invert the flag
+         */
+        void flip () {
+            *word ^= mask;
+        }
+    };
+
+    // --------
+    // iterator
+    // --------
+
+    class iterator {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef std::bidirectional_iterator_tag    iterator_category;
+        typedef typename my_deque::value_type      value_type;
+        typedef typename my_deque::difference_type difference_type;
+        typedef void                               pointer;
+        typedef typename my_deque::reference       reference;
+
+    public:
+        /**
+         * checks to see if the lhs == rhs
+         * @param   lhs the left hand side in question
+         * @param   rhs the right hand side in question
+         * @return  true if the lhs and rhs point to the same flag
+         */
+        friend bool operator == (const iterator& lhs, const iterator& rhs) {
+            return (lhs.owner == rhs.owner) && (lhs.index == rhs.index);
+        }
+
+        /**
+         * checks to see if the lhs != rhs
+         * @param   lhs the left hand side in question
+         * @param   rhs the right hand side in question
+         * @return  false if the lhs and rhs point to the same flag
+         */
+        friend bool operator != (const iterator& lhs, const iterator& rhs) {
+            return !(lhs == rhs);
+        }
+
+        /**
+         * adds a value to the iterator
+         * @param   lhs the iterator to add to
+         * @param   rhs the amount to add
+         * @return  the iterator with its new value
+         */
+        friend iterator operator + (iterator lhs, difference_type rhs) {
+            return lhs += rhs;
+        }
+
+        /**
+         * subtracts a value from the iterator
+         * @param   lhs the iterator to subtract from
+         * @param   rhs the amount to subtract
+         * @return  the iterator with its new value
+         */
+        friend iterator operator - (iterator lhs, difference_type rhs) {
+            return lhs -= rhs;
+        }
+
+    private:
+        friend class my_deque;
+
+        my_deque *owner;
+        size_t index;
+
+        bool valid () const {
+            return (owner != NULL) && (index <= owner->end_index);
+        }
+
+    public:
+        /**
+         * creates a new my_deque<bool>::iterator
+         * @param   *owner_ a pointer to the underlying container
+         * @param   index_ the absolute bit to point to
+         */
+        iterator (my_deque *owner_, size_t index_) :
+        owner(owner_), index(index_)
+        {
+            assert(valid());
+        }
+
+        /**
+         * dereference this iterator
+         * @returns a proxy for the flag at which this iterator is pointing
+         */
+        reference operator * () const {
+            return reference(&owner->word_at(index >> DIV_WORD_SHIFT), 1ULL << (index & MOD_WORD_MASK));
+        }
+
+        /**
+         * increment (pre) this iterator by one
+         * @returns iterator with its NEW value
+         */
+        iterator& operator ++ () {
+            ++index;
+            assert(valid());
+            return *this;
+        }
+
+        /**
+         * increment (post) this iterator by one
+         * @returns iterator with its OLD value
+         */
+        iterator operator ++ (int) {
+            iterator x = *this;
+            ++(*this);
+            return x;
+        }
+
+        /**
+         * decrement (pre) this iterator by one
+         * @returns iterator with its NEW value
+         */
+        iterator& operator -- () {
+            --index;
+            assert(valid());
+            return *this;
+        }
+
+        /**
+         * decrement (post) this iterator by one
+         * @returns iterator with its OLD value
+         */
+        iterator operator -- (int) {
+            iterator x = *this;
+            --(*this);
+            return x;
+        }
+
+        /**
+         * increment this iterator by a value d
+         * @param d the value to increment by
+         * @returns iterator with its NEW value
+         */
+        iterator& operator += (difference_type d) {
+            index += d;
+            assert(valid());
+            return *this;
+        }
+
+        /**
+         * decrement this iterator by a value d
+         * @param d the value to decrement by
+         * @returns iterator with its NEW value
+         */
+        iterator& operator -= (difference_type d) {
+            index -= d;
+            assert(valid());
+            return *this;
+        }
+    };
+
+    // --------------
+    // const_iterator
+    // --------------
+
+    class const_iterator {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef std::bidirectional_iterator_tag    iterator_category;
+        typedef typename my_deque::value_type      value_type;
+        typedef typename my_deque::difference_type difference_type;
+        typedef void                               pointer;
+        typedef typename my_deque::const_reference reference;
+
+    public:
+        /**
+         * checks to see if the lhs == rhs
+         * @param   lhs the left hand side in question
+         * @param   rhs the right hand side in question
+         * @return  true if the lhs and rhs point to the same flag
+         */
+        friend bool operator == (const const_iterator& lhs, const const_iterator& rhs) {
+            return (lhs.owner == rhs.owner) && (lhs.index == rhs.index);
+        }
+
+        /**
+         * checks to see if the lhs != rhs
+         * @param   lhs the left hand side in question
+         * @param   rhs the right hand side in question
+         * @return  false if the lhs and rhs point to the same flag
+         */
+        friend bool operator != (const const_iterator& lhs, const const_iterator& rhs) {
+            return !(lhs == rhs);
+        }
+
+        /**
+         * adds a value to the iterator
+         * @param   lhs the iterator to add to
+         * @param   rhs the amount to add
+         * @return  the iterator with its new value
+         */
+        friend const_iterator operator + (const_iterator lhs, difference_type rhs) {
+            return lhs += rhs;
+        }
+
+        /**
+         * subtracts a value from the iterator
+         * @param   lhs the iterator to subtract from
+         * @param   rhs the amount to subtract
+         * @return  the iterator with its new value
+         */
+        friend const_iterator operator - (const_iterator lhs, difference_type rhs) {
+            return lhs -= rhs;
+        }
+
+    private:
+        const my_deque *owner;
+        size_t index;
+
+        bool valid () const {
+            return (owner != NULL) && (index <= owner->end_index);
+        }
+
+    public:
+        /**
+         * creates a new my_deque<bool>::const_iterator
+         * @param   *owner_ a pointer to the underlying container
+         * @param   index_ the absolute bit to point to
+         */
+        const_iterator (const my_deque *owner_, size_t index_) :
+        owner(owner_), index(index_)
+        {}
+
+        /**
+         * dereference this iterator
+         * @returns the flag at which this iterator is pointing
+         */
+        reference operator * () const {
+            return (owner->word_at(index >> DIV_WORD_SHIFT) >> (index & MOD_WORD_MASK)) & 1;
+        }
+
+        /**
+         * increment (pre) this iterator by one
+         * @returns iterator with its NEW value
+         */
+        const_iterator& operator ++ () {
+            ++index;
+            assert(valid());
+            return *this;
+        }
+
+        /**
+         * increment (post) this iterator by one
+         * @returns iterator with its OLD value
+         */
+        const_iterator operator ++ (int) {
+            const_iterator x = *this;
+            ++(*this);
+            return x;
+        }
+
+        /**
+         * decrement (pre) this iterator by one
+         * @returns iterator with its NEW value
+         */
+        const_iterator& operator -- () {
+            --index;
+            assert(valid());
+            return *this;
+        }
+
+        /**
+         * decrement (post) this iterator by one
+         * @returns iterator with its OLD value
+         */
+        const_iterator operator -- (int) {
+            const_iterator x = *this;
+            --(*this);
+            return x;
+        }
+
+        /**
+         * increment this iterator by a value d
+         * @param d the value to increment by
+         * @returns iterator with its NEW value
+         */
+        const_iterator& operator += (difference_type d) {
+            index += d;
+            assert(valid());
+            return *this;
+        }
+
+        /**
+         * decrement this iterator by a value d
+         * @param d the value to decrement by
+         * @returns iterator with its NEW value
+         */
+        const_iterator& operator -= (difference_type d) {
+            index -= d;
+            assert(valid());
+            return *this;
+        }
+    };
+
+public:
+    // ------------
+    // constructors
+    // ------------
+
+    /**
+     * create a new, empty deque of flags
+     * @param   a the allocator to be used for this deque
+     */
+    explicit my_deque (const allocator_type& a = allocator_type()) :
+    _w(a), _ap(a)
+    {
+        allocate_map(1);
+        begin_index = ROW_BITS >> 1; //start at the middle
+        end_index = begin_index;
+        assert(valid());
+    }
+
+    /**
+     * create a new deque of s flags, all set to v
+     * @param   s the size of the deque to be created
+     * @param   v the value of every flag (optional)
+     * @param   a the allocator to be used for this deque
+     */
+    explicit my_deque (size_type s, const_reference v = value_type(), const allocator_type& a = allocator_type()) :
+    _w(a), _ap(a)
+    {
+        allocate_map(std::max<size_t>(1, (s + ROW_BITS - 1) >> ROW_BIT_SHIFT));
+        begin_index = 0;
+        end_index = 0;
+        push_back_n(s, v);
+        assert(valid());
+    }
+
+    /**
+     * create a new deque containing the same flags as that
+     * @param   that the deque to be replicated
+     */
+    my_deque (const my_deque& that) :
+    _w(that._w), _ap(that._ap)
+    {
+        allocate_map(std::max<size_t>(1, (that.size() + ROW_BITS - 1) >> ROW_BIT_SHIFT));
+        begin_index = 0;
+        end_index = 0;
+        append_bits(that);
+        assert(valid());
+    }
+
+    // ----------
+    // destructor
+    // ----------
+
+    /**
+     * free all rows and the map
+     */
+    ~my_deque () {
+        if(deque_root)
+            free_map();
+    }
+
+    // ----------
+    // operator =
+    // ----------
+
+    /**
+     * assignment operator, will set this to have values equivalent of rhs
+     * @param rhs the deque that is to be replicated into this
+     * @returns this
+     */
+    my_deque& operator = (const my_deque& rhs) {
+        if(this == &rhs)
+            return *this;
+        end_index = begin_index;
+        append_bits(rhs);
+        assert(valid());
+        return *this;
+    }
+
+    // -----------
+    // operator []
+    // -----------
+
+    /**
+     * index this deque
+     * @param index the index in this deque to be evaluated
+     * @return a proxy for the flag at index
+     */
+    reference operator [] (size_type index) {
+        return *iterator(this, begin_index + index);
+    }
+
+    /**
+     * index this deque, does not allow write
+     * @param index the index in this deque to be evaluated
+     * @return the flag at index
+     */
+    const_reference operator [] (size_type index) const {
+        return *const_iterator(this, begin_index + index);
+    }
+
+    // --
+    // at
+    // --
+
+    /**
+     * index this deque
+     * @param index the index in this deque to be evaluated
+     * @return a proxy for the flag at index
+     * @throws out_of_range if the index is greater or equal to size
+     */
+    reference at (size_type index) {
+        if(index >= size())
+            throw std::out_of_range("at index out of range");
+        return (*this)[index];
+    }
+
+    /**
+     * index this deque (read only)
+     * @param index the index in this deque to be evaluated
+     * @return the flag at index
+     * @throws out_of_range if the index is greater or equal to size
+     */
+    const_reference at (size_type index) const {
+        if(index >= size())
+            throw std::out_of_range("at index out of range");
+        return (*this)[index];
+    }
+
+    // -----
+    // front
+    // -----
+
+    /**
+     * @returns a proxy for the flag at the front of the deque
+     */
+    reference front () {
+        return (*this)[0];
+    }
+
+    /**
+     * @returns the flag at the front of the deque
+     */
+    const_reference front () const {
+        return (*this)[0];
+    }
+
+    // ----
+    // back
+    // ----
+
+    /**
+     * @returns a proxy for the flag at the back of the deque
+     */
+    reference back () {
+        return (*this)[size() - 1];
+    }
+
+    /**
+     * @returns the flag at the back of the deque
+     */
+    const_reference back () const {
+        return (*this)[size() - 1];
+    }
+
+    // -----
+    // clear
+    // -----
+
+    /**
+     * clears this deque, deallocating all memory
+     */
+    void clear () {
+        free_map();
+        allocate_map(1);
+        begin_index = ROW_BITS >> 1;
+        end_index = begin_index;
+        assert(valid());
+    }
+
+    // -----
+    // count
+    // -----
+
+    /**
+     * count the flags equal to v a word at a time
+     * @param v the value to count (optional)
+     * @returns how many flags equal v
+     */
+    size_type count (bool v = true) const {
+        size_type n = 0;
+        for(size_t i = begin_index; i < end_index; ) {
+            size_t take = std::min<size_t>(WORD_BITS - (i & MOD_WORD_MASK), end_index - i);
+            n += __builtin_popcountll(get_bits(i, take));
+            i += take;
+        }
+        return v ? n : size() - n;
+    }
+
+    // -----
+    // empty
+    // -----
+
+    /**
+     * checks to see if the deque contains any values
+     * @returns true if size == 0
+     */
+    bool empty () const {
+        return !size();
+    }
+
+    // -----
+    // begin
+    // -----
+
+    /**
+     * @returns an iterator pointing to the first flag
+     */
+    iterator begin () {
+        return iterator(this, begin_index);
+    }
+
+    /**
+     * @returns an iterator pointing to the first flag (read only)
+     */
+    const_iterator begin () const {
+        return const_iterator(this, begin_index);
+    }
+
+    // ---
+    // end
+    // ---
+
+    /**
+     * @returns an iterator pointing past the last flag
+     */
+    iterator end () {
+        return iterator(this, end_index);
+    }
+
+    /**
+     * @returns an iterator pointing past the last flag (read only)
+     */
+    const_iterator end () const {
+        return const_iterator(this, end_index);
+    }
+
+    // -----
+    // erase
+    // -----
+
+    /**
+     * erase a flag, sliding the following flags down a word at a time
+     * @return an iterator pointing to the flag after the one erased
+     */
+    iterator erase (iterator remove) {
+        for(size_t i = remove.index + 1; i < end_index; ) {
+            size_t take = std::min<size_t>(WORD_BITS, end_index - i);
+            set_bits(i - 1, take, get_bits(i, take));
+            i += take;
+        }
+        --end_index;
+        assert(valid());
+        return remove;
+    }
+
+    // ----------
+    // find_first
+    // ----------
+
+    /**
+     * find the first flag equal to v a word at a time
+     * @param v the value to look for (optional)
+     * @returns its index, or size() if there is none
+     */
+    size_type find_first (bool v = true) const {
+        word_type flip = v ? 0 : ~0ULL;
+        for(size_t i = begin_index; i < end_index; ) {
+            size_t take = std::min<size_t>(WORD_BITS - (i & MOD_WORD_MASK), end_index - i);
+            word_type bits = (get_bits(i, take) ^ flip) & low_mask(take);
+            if(bits)
+                return i - begin_index + __builtin_ctzll(bits);
+            i += take;
+        }
+        return size();
+    }
+
+    // ------
+    // insert
+    // ------
+
+    /**
+     * insert a flag, sliding the following flags up a word at a time
+     * @param spot where to insert the value
+     * @param ins the value to be inserted
+     * @return an iterator pointing to the value inserted
+     */
+    iterator insert (iterator spot, const_reference ins) {
+        size_t offset = spot.index - begin_index;
+        push_back(false);
+        size_t i = end_index - 1;
+        size_t stop = begin_index + offset;
+        while(i > stop) {
+            size_t take = std::min<size_t>(WORD_BITS, i - stop);
+            set_bits(i - take + 1, take, get_bits(i - take, take));
+            i -= take;
+        }
+        (*this)[offset] = ins;
+        assert(valid());
+        return iterator(this, begin_index + offset);
+    }
+
+    // ---
+    // pop
+    // ---
+
+    /**
+     * removes the flag at the back of the deque
+     */
+    void pop_back () {
+        assert(!empty());
+        --end_index;
+        assert(valid());
+    }
+
+    /**
+     * removes the flag at the front of the deque without moving the others,
+     * freeing the row it leaves behind
+     */
+    void pop_front () {
+        assert(!empty());
+        ++begin_index;
+        if(!(begin_index & (ROW_BITS - 1))) {
+            word_type*& row = deque_root[(begin_index >> ROW_BIT_SHIFT) - 1];
+            _w.deallocate(row, INITIAL_ROW_SIZE);
+            row = NULL;
+        }
+        assert(valid());
+    }
+
+    // ----
+    // push
+    // ----
+
+    /**
+     * push a flag onto the back side of this deque
+     * @param val the value to add to the deque
+     */
+    void push_back (const_reference val) {
+        reserve_back(1);
+        touch_row(end_index);
+        ++end_index;
+        back() = val;
+        assert(valid());
+    }
+
+    /**
+     * push n copies of a flag onto the back side of this deque, filling whole words at once
+     * @param n how many flags to add
+     * @param val the value to add to the deque
+     */
+    void push_back_n (size_type n, const_reference val) {
+        if(!n)
+            return;
+        reserve_back(n);
+        word_type bits = val ? ~0ULL : 0;
+        for(size_t i = end_index, e = end_index + n; i < e; ) {
+            size_t take = std::min<size_t>(WORD_BITS - (i & MOD_WORD_MASK), e - i);
+            touch_row(i);
+            set_bits(i, take, bits);
+            i += take;
+        }
+        end_index += n;
+        assert(valid());
+    }
+
+    /**
+     * push a flag onto the front side of this deque
+     * @param val the value to add to the deque
+     */
+    void push_front (const_reference val) {
+        if(begin_index == 0)
+            reserve_rows(1, true);
+        --begin_index;
+        touch_row(begin_index);
+        front() = val;
+        assert(valid());
+    }
+
+    // ------
+    // resize
+    // ------
+
+    /**
+     * resize this deque to a given amount
+     * @param s the number of flags this deque should hold
+     * @param v the value to fill any extra slots with
+     */
+    void resize (size_type s, const_reference v = value_type()) {
+        if(s > size())
+            push_back_n(s - size(), v);
+        else
+            end_index = begin_index + s;
+        assert(valid());
+    }
+
+    // ----
+    // size
+    // ----
+
+    /**
+     * @returns the number of flags in this deque
+     */
+    size_type size () const {
+        return end_index - begin_index;
+    }
+
+    // ----
+    // swap
+    // ----
+
+    /**
+     * swap this deque's values with another
+     * @param other the other deque to be swapped with
+     */
+    void swap (my_deque& other) {
+        if (_w == other._w && _ap == other._ap) {
+            std::swap(deque_root, other.deque_root);
+            std::swap(row_count, other.row_count);
+            std::swap(begin_index, other.begin_index);
+            std::swap(end_index, other.end_index);
+        }
+        else {
+            my_deque x = *this;
+            *this = other;
+            other  = x;
+        }
+        assert(valid());
+    }
+};
+
 #endif // Deque_h
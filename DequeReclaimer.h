@@ -0,0 +1,206 @@
+// -------------------------------
+// projects/deque/DequeReclaimer.h
+// Copyright (C) 2014
+// Taylor Gregston
+// -------------------------------
+
+#ifndef DequeReclaimer_h
+#define DequeReclaimer_h
+
+// --------
+// includes
+// --------
+
+#include <condition_variable> // condition_variable
+#include <cstddef>   // size_t
+#include <mutex>     // mutex, lock_guard, unique_lock
+#include <thread>    // thread
+#include <vector>    // vector
+
+#include "Deque.h"   // reclaim_job, reclaim_sink
+
+// -------
+// defines
+// -------
+
+#define RECLAIM_MAX_ROWS    1048576 // default bound on the backlog, in rows
+
+// ---------------
+// deque_reclaimer
+// ---------------
+
+/**
+ * A background thread that destroys the values and frees the rows my_deques detach, so
+ * clear(), destruction and pop_front_n cost the caller O(1) or O(rows) instead of a
+ * destructor call per value.
+ * The thread takes every pending job at once and runs the batch without the lock held.
+ * The backlog is bounded: a job that would take it past max_rows() is refused, and the
+ * deque runs that job itself, so memory waiting to be freed never grows without limit.
+ * The allocators of the deques using it must be safe to call from another thread.
+ * A deque_reclaimer must outlive every deque pointed at it; its destructor finishes the
+ * backlog before it returns.
+ */
+class deque_reclaimer : public reclaim_sink {
+private:
+    // ----
+    // data
+    // ----
+
+    mutable std::mutex lock;
+    std::condition_variable work;   //signalled when jobs arrive or on shutdown
+    std::condition_variable idle;   //signalled when a batch is done
+    std::vector<reclaim_job*> jobs; //waiting for the thread
+    size_t bound;       //most rows waiting or being reclaimed
+    size_t pending;     //rows waiting or being reclaimed
+    size_t reclaimed;   //rows reclaimed in total
+    size_t refused;     //jobs sent back to run on the caller
+    bool stopping;
+    std::thread worker;
+
+private:
+    deque_reclaimer (const deque_reclaimer&);
+    deque_reclaimer& operator = (const deque_reclaimer&);
+
+    /**
+     * the thread: run every batch of jobs until shut down with nothing left
+     */
+    void loop () {
+        std::unique_lock<std::mutex> guard(lock);
+        for(;;) {
+            while(jobs.empty() && !stopping)
+                work.wait(guard);
+            if(jobs.empty())
+                return;
+            std::vector<reclaim_job*> batch;
+            batch.swap(jobs);
+            guard.unlock();
+
+            size_t rows = 0;
+            for(size_t i = 0; i < batch.size(); ++i) {
+                rows += batch[i]->rows;
+                batch[i]->run();
+                delete batch[i];
+            }
+
+            guard.lock();
+            pending -= rows;
+            reclaimed += rows;
+            idle.notify_all();
+        }
+    }
+
+public:
+    // ------------
+    // constructors
+    // ------------
+
+    /**
+     * start the reclaiming thread
+     * @param   max_rows the most rows that may wait to be reclaimed
+     */
+    explicit deque_reclaimer (size_t max_rows = RECLAIM_MAX_ROWS) :
+    bound(max_rows), pending(0), reclaimed(0), refused(0), stopping(false),
+    worker(&deque_reclaimer::loop, this)
+    {}
+
+    // ----------
+    // destructor
+    // ----------
+
+    /**
+     * reclaim the whole backlog, then stop the thread
+     */
+    ~deque_reclaimer () {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        work.notify_one();
+        worker.join();
+    }
+
+    // -----
+    // drain
+    // -----
+
+    /**
+     * wait until every job taken so far has been reclaimed
+     */
+    void drain () {
+        std::unique_lock<std::mutex> guard(lock);
+        while(pending)
+            idle.wait(guard);
+    }
+
+    // --------
+    // max_rows
+    // --------
+
+    /**
+     * @returns the bound on the backlog, in rows
+     */
+    size_t max_rows () const {
+        return bound;
+    }
+
+    // ------------
+    // pending_rows
+    // ------------
+
+    /**
+     * @returns the rows waiting or being reclaimed
+     */
+    size_t pending_rows () const {
+        std::lock_guard<std::mutex> guard(lock);
+        return pending;
+    }
+
+    // --------------
+    // reclaimed_rows
+    // --------------
+
+    /**
+     * @returns the rows reclaimed on the thread so far
+     */
+    size_t reclaimed_rows () const {
+        std::lock_guard<std::mutex> guard(lock);
+        return reclaimed;
+    }
+
+    // ------------
+    // refused_jobs
+    // ------------
+
+    /**
+     * @returns how many jobs were refused, and run by the deque, because of the bound
+     */
+    size_t refused_jobs () const {
+        std::lock_guard<std::mutex> guard(lock);
+        return refused;
+    }
+
+    // ----
+    // take
+    // ----
+
+    /**
+     * queue a job for the thread unless it would take the backlog past max_rows()
+     * @param   j the job, owned by the reclaimer if taken
+     * @return  false if the caller has to run the job itself
+     */
+    bool take (reclaim_job* j) {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if(pending + j->rows > bound) {
+                ++refused;
+                return false;
+            }
+            jobs.push_back(j);
+            pending += j->rows;
+        }
+        work.notify_one();
+        return true;
+    }
+};
+
+#endif // DequeReclaimer_h
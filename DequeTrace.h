@@ -0,0 +1,411 @@
+// ---------------------------
+// projects/deque/DequeTrace.h
+// Copyright (C) 2014
+// Taylor Gregston
+// ---------------------------
+
+#ifndef DequeTrace_h
+#define DequeTrace_h
+
+// --------
+// includes
+// --------
+
+#include <cstddef>   // size_t
+#include <cstring>   // memcmp, memcpy
+#include <istream>   // istream
+#include <iterator>  // istreambuf_iterator
+#include <memory>    // allocator
+#include <ostream>   // ostream
+#include <stdexcept> // runtime_error
+#include <type_traits> // is_arithmetic
+#include <vector>    // vector
+
+#include "Deque.h"
+
+// -------
+// defines
+// -------
+
+/**
+ * A trace is a TRACE_HEADER byte header, the magic TRACE_MAGIC and a version, followed by
+ * one record per call: a code byte, then the index for the calls that take one and the
+ * value for the calls that take one, each as a LEB128 varint, values zigzagged first.
+ * Values are kept for arithmetic element types only and are 0 otherwise, so a trace
+ * describes the mix of calls and the positions and sizes they hit, not the data.
+ */
+
+#define TRACE_MAGIC         "MYDT"
+#define TRACE_VERSION       1
+#define TRACE_HEADER        8
+#define TRACE_BUFFER        65536   // bytes a trace_writer gathers before writing them out
+#define TRACE_RECORD_MAX    21      // code byte and two 10 byte varints
+
+enum trace_code {
+    TRACE_PUSH_BACK = 1,    //value
+    TRACE_PUSH_FRONT,       //value
+    TRACE_POP_BACK,
+    TRACE_POP_FRONT,
+    TRACE_INDEX,            //index
+    TRACE_INSERT,           //index, value
+    TRACE_ERASE,            //index
+    TRACE_CLEAR
+};
+
+// --------
+// trace_op
+// --------
+
+/**
+ * One decoded record.
+ */
+struct trace_op {
+    unsigned char      code;
+    unsigned long long index;
+    long long          value;
+};
+
+// ------------
+// trace_writer
+// ------------
+
+/**
+ * Encodes records into a buffer and writes it to a stream TRACE_BUFFER bytes at a time,
+ * so recording a call costs a few stores.
+ */
+class trace_writer {
+private:
+    // ----
+    // data
+    // ----
+
+    std::ostream& out;
+    char buffer[TRACE_BUFFER];
+    size_t used;
+
+private:
+    trace_writer (const trace_writer&);
+    trace_writer& operator = (const trace_writer&);
+
+    void put (unsigned long long v) {
+        while(v >= 0x80) {
+            buffer[used++] = char(v | 0x80);
+            v >>= 7;
+        }
+        buffer[used++] = char(v);
+    }
+
+public:
+    // ------------
+    // constructors
+    // ------------
+
+    /**
+     * start a trace on out, writing its header
+     */
+    explicit trace_writer (std::ostream& out_) :
+    out(out_), used(0)
+    {
+        char h[TRACE_HEADER] = {};
+        unsigned version = TRACE_VERSION;
+        std::memcpy(h, TRACE_MAGIC, 4);
+        std::memcpy(h + 4, &version, 4);
+        out.write(h, TRACE_HEADER);
+    }
+
+    // ----------
+    // destructor
+    // ----------
+
+    ~trace_writer () {
+        flush();
+    }
+
+    // -----
+    // flush
+    // -----
+
+    /**
+     * write out what is buffered
+     */
+    void flush () {
+        out.write(buffer, used);
+        out.flush();
+        used = 0;
+    }
+
+    // ------
+    // record
+    // ------
+
+    /**
+     * @param   code the call
+     * @param   index its index, if it takes one
+     * @param   value its value, if it takes one
+     */
+    void record (trace_code code, unsigned long long index = 0, long long value = 0) {
+        if(used > TRACE_BUFFER - TRACE_RECORD_MAX)
+            flush();
+        buffer[used++] = char(code);
+        if((code == TRACE_INDEX) || (code == TRACE_INSERT) || (code == TRACE_ERASE))
+            put(index);
+        if((code == TRACE_PUSH_BACK) || (code == TRACE_PUSH_FRONT) || (code == TRACE_INSERT))
+            put((static_cast<unsigned long long>(value) << 1) ^ static_cast<unsigned long long>(value >> 63));
+    }
+};
+
+// ----------
+// read_trace
+// ----------
+
+/**
+ * decode a whole trace, so replaying it times the deque and not the decoding
+ * @param   in a stream positioned at a trace header
+ * @return  every record in order
+ * @throws  runtime_error if the header is wrong or the trace is cut short or corrupt
+ */
+inline std::vector<trace_op> read_trace (std::istream& in) {
+    char h[TRACE_HEADER];
+    unsigned version = 0;
+    if(!in.read(h, TRACE_HEADER) || std::memcmp(h, TRACE_MAGIC, 4))
+        throw std::runtime_error("read_trace bad header");
+    std::memcpy(&version, h + 4, 4);
+    if(version != TRACE_VERSION)
+        throw std::runtime_error("read_trace bad header");
+
+    std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::vector<trace_op> ops;
+    size_t i = 0;
+    auto get = [&] () -> unsigned long long {
+        unsigned long long v = 0;
+        for(unsigned shift = 0; ; shift += 7) {
+            if((i == bytes.size()) || (shift > 63))
+                throw std::runtime_error("read_trace short record");
+            unsigned char c = bytes[i++];
+            v |= (unsigned long long)(c & 0x7F) << shift;
+            if(!(c & 0x80))
+                return v;
+        }};
+    while(i < bytes.size()) {
+        trace_op op = {static_cast<unsigned char>(bytes[i++]), 0, 0};
+        if((op.code < TRACE_PUSH_BACK) || (op.code > TRACE_CLEAR))
+            throw std::runtime_error("read_trace bad code");
+        if((op.code == TRACE_INDEX) || (op.code == TRACE_INSERT) || (op.code == TRACE_ERASE))
+            op.index = get();
+        if((op.code == TRACE_PUSH_BACK) || (op.code == TRACE_PUSH_FRONT) || (op.code == TRACE_INSERT)) {
+            unsigned long long z = get();
+            op.value = static_cast<long long>(z >> 1) ^ -static_cast<long long>(z & 1);
+        }
+        ops.push_back(op);
+    }
+    return ops;
+}
+
+// -----------
+// trace_apply
+// -----------
+
+/**
+ * run one record against a deque of long long, my_deque or std::deque
+ * @param   d the deque
+ * @param   op the record
+ * @return  the value read for TRACE_INDEX, 0 otherwise
+ */
+template <typename D>
+long long trace_apply (D& d, const trace_op& op) {
+    switch(op.code) {
+        case TRACE_PUSH_BACK:
+            d.push_back(op.value);
+            break;
+        case TRACE_PUSH_FRONT:
+            d.push_front(op.value);
+            break;
+        case TRACE_POP_BACK:
+            d.pop_back();
+            break;
+        case TRACE_POP_FRONT:
+            d.pop_front();
+            break;
+        case TRACE_INDEX:
+            return d[op.index];
+        case TRACE_INSERT:
+            d.insert(d.begin() + op.index, op.value);
+            break;
+        case TRACE_ERASE:
+            d.erase(d.begin() + op.index);
+            break;
+        case TRACE_CLEAR:
+            d.clear();
+            break;
+    }
+    return 0;
+}
+
+// ---------------
+// recording_deque
+// ---------------
+
+/**
+ * A my_deque that records every push, pop, operator[], insert, erase and clear to a
+ * trace_writer before doing it. The rest of my_deque is reached through deque().
+ */
+template < typename T, typename A = std::allocator<T> >
+class recording_deque {
+public:
+    // --------
+    // typedefs
+    // --------
+
+    typedef my_deque<T, A>                      deque_type;
+    typedef typename deque_type::value_type     value_type;
+    typedef typename deque_type::size_type      size_type;
+    typedef typename deque_type::iterator       iterator;
+    typedef typename deque_type::const_iterator const_iterator;
+    typedef typename deque_type::reference      reference;
+    typedef typename deque_type::const_reference const_reference;
+
+private:
+    // ----
+    // data
+    // ----
+
+    deque_type d;
+    trace_writer& w;
+
+private:
+    /**
+     * @return  v as it goes in a trace, 0 unless T is arithmetic
+     */
+    template <typename U>
+    static long long traced (const U& v, typename std::enable_if<std::is_arithmetic<U>::value>::type* = 0) {
+        return static_cast<long long>(v);
+    }
+
+    template <typename U>
+    static long long traced (const U&, typename std::enable_if<!std::is_arithmetic<U>::value>::type* = 0) {
+        return 0;
+    }
+
+public:
+    // ------------
+    // constructors
+    // ------------
+
+    /**
+     * @param   w_ where to record the calls
+     * @param   a the allocator to be used for the deque
+     */
+    explicit recording_deque (trace_writer& w_, const A& a = A()) :
+    d(a), w(w_)
+    {}
+
+    // -----------
+    // operator []
+    // -----------
+
+    reference operator [] (size_type index) {
+        w.record(TRACE_INDEX, index);
+        return d[index];
+    }
+
+    const_reference operator [] (size_type index) const {
+        w.record(TRACE_INDEX, index);
+        return d[index];
+    }
+
+    // -----
+    // begin
+    // -----
+
+    iterator begin () {
+        return d.begin();
+    }
+
+    // -----
+    // clear
+    // -----
+
+    void clear () {
+        w.record(TRACE_CLEAR);
+        d.clear();
+    }
+
+    // -----
+    // deque
+    // -----
+
+    /**
+     * @returns the deque being recorded, calls made on it directly are not recorded
+     */
+    deque_type& deque () {
+        return d;
+    }
+
+    const deque_type& deque () const {
+        return d;
+    }
+
+    // ---
+    // end
+    // ---
+
+    iterator end () {
+        return d.end();
+    }
+
+    // -----
+    // erase
+    // -----
+
+    iterator erase (iterator remove) {
+        w.record(TRACE_ERASE, remove - d.begin());
+        return d.erase(remove);
+    }
+
+    // ------
+    // insert
+    // ------
+
+    iterator insert (iterator spot, const_reference v) {
+        w.record(TRACE_INSERT, spot - d.begin(), traced(v));
+        return d.insert(spot, v);
+    }
+
+    // ---
+    // pop
+    // ---
+
+    void pop_back () {
+        w.record(TRACE_POP_BACK);
+        d.pop_back();
+    }
+
+    void pop_front () {
+        w.record(TRACE_POP_FRONT);
+        d.pop_front();
+    }
+
+    // ----
+    // push
+    // ----
+
+    void push_back (const_reference v) {
+        w.record(TRACE_PUSH_BACK, 0, traced(v));
+        d.push_back(v);
+    }
+
+    void push_front (const_reference v) {
+        w.record(TRACE_PUSH_FRONT, 0, traced(v));
+        d.push_front(v);
+    }
+
+    // ----
+    // size
+    // ----
+
+    size_type size () const {
+        return d.size();
+    }
+};
+
+#endif // DequeTrace_h
@@ -0,0 +1,308 @@
+// ---------------------------
+// projects/deque/MinMaxHeap.h
+// Copyright (C) 2014
+// Taylor Gregston
+// ---------------------------
+
+#ifndef MinMaxHeap_h
+#define MinMaxHeap_h
+
+// --------
+// includes
+// --------
+
+#include <cassert>    // assert
+#include <cstddef>    // size_t
+#include <functional> // less
+#include <utility>    // swap
+
+#include "Deque.h"
+
+// -----------
+// minmax_heap
+// -----------
+
+/**
+ * A double-ended priority queue: the smallest and the largest value can both be read in O(1)
+ * and popped in O(log n).
+ * This is a min-max heap kept in a container with random access operator[], by default
+ * my_deque, so growing never moves the values already in the heap.
+ * Values on even levels of the tree (the root is level 0) are no greater than anything below
+ * them, values on odd levels are no less than anything below them.
+ */
+template < typename T, typename Compare = std::less<T>, typename C = my_deque<T> >
+class minmax_heap {
+public:
+    // --------
+    // typedefs
+    // --------
+
+    typedef C                                   container_type;
+    typedef Compare                             value_compare;
+    typedef typename container_type::value_type value_type;
+    typedef typename container_type::size_type  size_type;
+
+    typedef typename container_type::reference       reference;
+    typedef typename container_type::const_reference const_reference;
+
+protected:
+    // ----
+    // data
+    // ----
+
+    container_type c;   //the heap, level by level
+    value_compare comp; //the ordering
+
+private:
+    // -----
+    // valid
+    // -----
+
+    bool valid () const {
+        for(size_t i = 1; i < 3 && i < c.size(); ++i) {
+            if(comp(c[i], c[0]))
+                return false;
+        }
+        return true;
+    }
+
+    static size_t parent (size_t i) {
+        return (i - 1) >> 1;
+    }
+
+    /**
+     * @return  true if slot i is on an even (min) level
+     */
+    static bool min_level (size_t i) {
+        return !((63 - __builtin_clzll(i + 1)) & 1);
+    }
+
+    /**
+     * @return  comp(a, b) on min levels, comp(b, a) on max levels
+     */
+    bool before (const_reference a, const_reference b, bool is_min) const {
+        return is_min ? comp(a, b) : comp(b, a);
+    }
+
+    /**
+     * move slot i up past grandparents that it should come before
+     */
+    void bubble_up_to (size_t i, bool is_min) {
+        while(i > 2) {
+            size_t g = parent(parent(i));
+            if(!before(c[i], c[g], is_min))
+                break;
+            std::swap(c[i], c[g]);
+            i = g;
+        }
+    }
+
+    /**
+     * restore the heap after a value was placed at slot i at the bottom
+     */
+    void bubble_up (size_t i) {
+        if(!i)
+            return;
+        size_t p = parent(i);
+        bool is_min = min_level(i);
+        if(before(c[p], c[i], is_min)) {
+            std::swap(c[i], c[p]);
+            bubble_up_to(p, !is_min);
+        }
+        else
+            bubble_up_to(i, is_min);
+    }
+
+    /**
+     * restore the heap below slot i after its value was replaced
+     */
+    void trickle_down (size_t i) {
+        const bool is_min = min_level(i);
+        const size_t n = c.size();
+        for(;;) {
+            size_t first = 2 * i + 1;
+            if(first >= n)
+                return;
+            //the best of the children and grandchildren
+            size_t m = first;
+            if(first + 1 < n && before(c[first + 1], c[m], is_min))
+                m = first + 1;
+            size_t g = 2 * first + 1;
+            for(size_t k = g; k < n && k < g + 4; ++k) {
+                if(before(c[k], c[m], is_min))
+                    m = k;
+            }
+
+            if(!before(c[m], c[i], is_min))
+                return;
+            std::swap(c[m], c[i]);
+            if(m <= first + 1)
+                return;
+            size_t p = parent(m);
+            if(before(c[p], c[m], is_min))
+                std::swap(c[m], c[p]);
+            i = m;
+        }
+    }
+
+    /**
+     * @return  the slot of the largest value
+     */
+    size_t max_index () const {
+        if(c.size() < 3)
+            return c.size() - 1;
+        return comp(c[1], c[2]) ? 2 : 1;
+    }
+
+    /**
+     * take the value at slot i out of the heap
+     */
+    void remove (size_t i) {
+        if(i + 1 != c.size())
+            std::swap(c[i], c.back());
+        c.pop_back();
+        if(i < c.size())
+            trickle_down(i);
+        assert(valid());
+    }
+
+public:
+    // ------------
+    // constructors
+    // ------------
+
+    /**
+     * create an empty heap
+     * @param   cmp the ordering
+     */
+    explicit minmax_heap (const value_compare& cmp = value_compare()) :
+    c(), comp(cmp)
+    {}
+
+    /**
+     * create a heap of the values in [b, e), built bottom up in O(n)
+     * @param   b the first value
+     * @param   e one past the last value
+     * @param   cmp the ordering
+     */
+    template <typename II>
+    minmax_heap (II b, II e, const value_compare& cmp = value_compare()) :
+    c(), comp(cmp)
+    {
+        assign(b, e);
+    }
+
+    // ------
+    // assign
+    // ------
+
+    /**
+     * replace the contents with the values in [b, e), built bottom up in O(n)
+     * @param   b the first value
+     * @param   e one past the last value
+     */
+    template <typename II>
+    void assign (II b, II e) {
+        c.clear();
+        for(; b != e; ++b)
+            c.push_back(*b);
+        for(size_t i = c.size() / 2; i-- > 0; )
+            trickle_down(i);
+        assert(valid());
+    }
+
+    // -----
+    // empty
+    // -----
+
+    /**
+     * @returns true if size == 0
+     */
+    bool empty () const {
+        return c.empty();
+    }
+
+    // ---
+    // max
+    // ---
+
+    /**
+     * @returns the largest value
+     */
+    const_reference max () const {
+        assert(!empty());
+        return c[max_index()];
+    }
+
+    // ---
+    // min
+    // ---
+
+    /**
+     * @returns the smallest value
+     */
+    const_reference min () const {
+        assert(!empty());
+        return c[0];
+    }
+
+    // ---
+    // pop
+    // ---
+
+    /**
+     * remove the largest value, O(log n)
+     */
+    void pop_max () {
+        assert(!empty());
+        remove(max_index());
+    }
+
+    /**
+     * remove the smallest value, O(log n)
+     */
+    void pop_min () {
+        assert(!empty());
+        remove(0);
+    }
+
+    // ----
+    // push
+    // ----
+
+    /**
+     * add a value, O(log n)
+     * @param val the value to add
+     */
+    void push (const_reference val) {
+        c.push_back(val);
+        bubble_up(c.size() - 1);
+        assert(valid());
+    }
+
+    // ----
+    // size
+    // ----
+
+    /**
+     * @returns the number of values in the heap
+     */
+    size_type size () const {
+        return c.size();
+    }
+
+    // ----
+    // swap
+    // ----
+
+    /**
+     * swap this heap's values with another
+     * @param other the other heap to be swapped with
+     */
+    void swap (minmax_heap& other) {
+        c.swap(other.c);
+        std::swap(comp, other.comp);
+    }
+};
+
+#endif // MinMaxHeap_h
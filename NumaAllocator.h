@@ -0,0 +1,399 @@
+// ------------------------------
+// projects/deque/NumaAllocator.h
+// Copyright (C) 2014
+// Taylor Gregston
+// ------------------------------
+
+#ifndef NumaAllocator_h
+#define NumaAllocator_h
+
+// --------
+// includes
+// --------
+
+#include <cstddef>   // size_t, ptrdiff_t
+#include <cstdlib>   // free, posix_memalign
+#include <map>       // map
+#include <memory>    // shared_ptr
+#include <mutex>     // mutex, lock_guard
+#include <new>       // bad_alloc, placement new
+#include <stdexcept> // invalid_argument
+#include <type_traits> // alignment_of
+#include <utility>   // forward
+#include <vector>    // vector
+
+#ifdef DEQUE_LIBNUMA
+#include <numa.h>    // numa_alloc_onnode, numa_free, numa_node_of_cpu
+#include <sched.h>   // sched_getcpu
+#endif
+
+#include "Deque.h"   // CACHE_LINE_SIZE
+
+// -------
+// defines
+// -------
+
+/**
+ * A numa_arena hands out blocks rounded up to CACHE_LINE_SIZE and aligned to it, so a
+ * my_deque row never shares a line with its neighbours. Blocks of ROW_PAGE_SIZE or more
+ * get pages of their own. Smaller blocks are cut from ROW_CHUNK_SIZE chunks of pages,
+ * each chunk taken from one node.
+ * Build with -DDEQUE_LIBNUMA and link -lnuma to place chunks with libnuma; without it
+ * there is one node and pages land wherever the kernel first touches them.
+ */
+
+#define ROW_PAGE_SIZE       4096    // THIS VALUE MUST BE a power of 2 and a multiple of CACHE_LINE_SIZE
+#define ROW_CHUNK_SIZE      262144  // THIS VALUE MUST BE a multiple of ROW_PAGE_SIZE
+#define NUMA_LOCAL          -1      // the node of whichever thread is allocating
+
+// ----------
+// numa_arena
+// ----------
+
+/**
+ * Per node pools of cache line aligned blocks, shared by every numa_allocator made from it.
+ * Freed small blocks go back on their node's list for their size and are reused; chunks
+ * are only given back to the system when the arena goes away.
+ * All of it is behind one mutex, so deques on different threads may share an arena.
+ */
+class numa_arena {
+private:
+    // ----
+    // pool
+    // ----
+
+    struct pool {
+        char* next;     //unused bytes of the newest chunk
+        char* limit;    //end of the newest chunk
+        std::map< size_t, std::vector<void*> > spare; //freed blocks by size
+
+        pool () :
+        next(0), limit(0)
+        {}
+    };
+
+private:
+    // ----
+    // data
+    // ----
+
+    std::mutex lock;
+    std::vector<pool> pools;        //one per node
+    std::map<char*, int> chunks;    //first byte of every chunk, and its node
+
+private:
+    numa_arena (const numa_arena&);
+    numa_arena& operator = (const numa_arena&);
+
+    /**
+     * @param   bytes a multiple of CACHE_LINE_SIZE
+     * @param   node where the pages should live
+     * @return  page aligned memory
+     * @throws  bad_alloc if there is none
+     */
+    static void* node_pages (size_t bytes, int node) {
+        void* p = 0;
+#ifdef DEQUE_LIBNUMA
+        if(numa_available() >= 0) {
+            p = numa_alloc_onnode(bytes, node);
+            if(!p)
+                throw std::bad_alloc();
+            return p;
+        }
+#endif
+        (void)node;
+        if(posix_memalign(&p, ROW_PAGE_SIZE, bytes))
+            throw std::bad_alloc();
+        return p;
+    }
+
+    /**
+     * give back what node_pages(bytes, ...) returned
+     */
+    static void free_pages (void* p, size_t bytes) {
+#ifdef DEQUE_LIBNUMA
+        if(numa_available() >= 0) {
+            numa_free(p, bytes);
+            return;
+        }
+#endif
+        (void)bytes;
+        std::free(p);
+    }
+
+    /**
+     * @return  bytes rounded up to a whole number of cache lines
+     */
+    static size_t block (size_t bytes) {
+        return (bytes + CACHE_LINE_SIZE - 1) & ~size_t(CACHE_LINE_SIZE - 1);
+    }
+
+public:
+    // ------------
+    // constructors
+    // ------------
+
+    numa_arena () :
+    pools(node_count())
+    {}
+
+    // ----------
+    // destructor
+    // ----------
+
+    /**
+     * give every chunk back, every block cut from them must already be freed
+     */
+    ~numa_arena () {
+        for(std::map<char*, int>::iterator it = chunks.begin(); it != chunks.end(); ++it)
+            free_pages(it->first, ROW_CHUNK_SIZE);
+    }
+
+    // ----------
+    // node_count
+    // ----------
+
+    /**
+     * @return  the number of NUMA nodes, 1 without libnuma
+     */
+    static int node_count () {
+#ifdef DEQUE_LIBNUMA
+        if(numa_available() >= 0)
+            return numa_max_node() + 1;
+#endif
+        return 1;
+    }
+
+    // ------------
+    // current_node
+    // ------------
+
+    /**
+     * @return  the node of the cpu this thread is running on, 0 without libnuma
+     */
+    static int current_node () {
+#ifdef DEQUE_LIBNUMA
+        if(numa_available() >= 0) {
+            int cpu = sched_getcpu();
+            int node = (cpu < 0) ? -1 : numa_node_of_cpu(cpu);
+            if(node >= 0)
+                return node;
+        }
+#endif
+        return 0;
+    }
+
+    // ------
+    // shared
+    // ------
+
+    /**
+     * @return  the arena default constructed numa_allocators use
+     */
+    static std::shared_ptr<numa_arena> shared () {
+        static std::shared_ptr<numa_arena> a(new numa_arena);
+        return a;
+    }
+
+    // --------
+    // allocate
+    // --------
+
+    /**
+     * @param   bytes the size of the block
+     * @param   node where it should live, or NUMA_LOCAL
+     * @return  a block aligned to a cache line, or to a page if it is a page or more
+     * @throws  invalid_argument if there is no such node
+     */
+    void* allocate (size_t bytes, int node) {
+        if(node == NUMA_LOCAL)
+            node = current_node();
+        if((node < 0) || (node >= (int)pools.size()))
+            throw std::invalid_argument("numa_arena no such node");
+        bytes = block(bytes);
+        if(bytes >= ROW_PAGE_SIZE)
+            return node_pages(bytes, node);
+
+        std::lock_guard<std::mutex> guard(lock);
+        pool& p = pools[node];
+        std::vector<void*>& s = p.spare[bytes];
+        if(!s.empty()) {
+            void* r = s.back();
+            s.pop_back();
+            return r;
+        }
+        if(p.limit - p.next < (std::ptrdiff_t)bytes) {
+            char* c = static_cast<char*>(node_pages(ROW_CHUNK_SIZE, node));
+            chunks[c] = node;
+            p.next = c;
+            p.limit = c + ROW_CHUNK_SIZE;
+        }
+        void* r = p.next;
+        p.next += bytes;
+        return r;
+    }
+
+    // ----------
+    // deallocate
+    // ----------
+
+    /**
+     * @param   q a block from allocate(bytes, ...)
+     * @param   bytes the same bytes
+     */
+    void deallocate (void* q, size_t bytes) {
+        bytes = block(bytes);
+        if(bytes >= ROW_PAGE_SIZE) {
+            free_pages(q, bytes);
+            return;
+        }
+        std::lock_guard<std::mutex> guard(lock);
+        std::map<char*, int>::iterator c = --chunks.upper_bound(static_cast<char*>(q));
+        pools[c->second].spare[bytes].push_back(q);
+    }
+};
+
+// --------------
+// numa_allocator
+// --------------
+
+/**
+ * An allocator for my_deque that gives each row its own cache lines, and places rows on
+ * a chosen NUMA node, or on the node of the thread that pushes them with NUMA_LOCAL.
+ * A producer on one socket filling a my_deque for a consumer on another should build it
+ * with the consumer's node, so the rows are read locally.
+ * Allocators from the same arena compare equal, whatever their node.
+ */
+template <typename T>
+class numa_allocator {
+public:
+    // --------
+    // typedefs
+    // --------
+
+    typedef T              value_type;
+    typedef size_t         size_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef T*             pointer;
+    typedef const T*       const_pointer;
+    typedef T&             reference;
+    typedef const T&       const_reference;
+
+    template <typename U>
+    struct rebind {
+        typedef numa_allocator<U> other;
+    };
+
+    static_assert(std::alignment_of<T>::value <= CACHE_LINE_SIZE, "numa_allocator aligns to cache lines only");
+
+public:
+    /**
+     * @return  true if either can free what the other allocated
+     */
+    friend bool operator == (const numa_allocator& lhs, const numa_allocator& rhs) {
+        return lhs.arena == rhs.arena;
+    }
+
+    friend bool operator != (const numa_allocator& lhs, const numa_allocator& rhs) {
+        return !(lhs == rhs);
+    }
+
+private:
+    // ----
+    // data
+    // ----
+
+    std::shared_ptr<numa_arena> arena;
+    int node;
+
+    template <typename U>
+    friend class numa_allocator;
+
+public:
+    // ------------
+    // constructors
+    // ------------
+
+    /**
+     * place rows on the node of the allocating thread, from the shared arena
+     */
+    numa_allocator () :
+    arena(numa_arena::shared()), node(NUMA_LOCAL)
+    {}
+
+    /**
+     * @param   node_ the node to place rows on, or NUMA_LOCAL
+     * @param   arena_ the arena to take them from
+     */
+    explicit numa_allocator (int node_, const std::shared_ptr<numa_arena>& arena_ = numa_arena::shared()) :
+    arena(arena_), node(node_)
+    {}
+
+    template <typename U>
+    numa_allocator (const numa_allocator<U>& that) :
+    arena(that.arena), node(that.node)
+    {}
+
+    // --------
+    // allocate
+    // --------
+
+    /**
+     * @param   n the number of objects to make room for
+     * @return  uninitialized room for n objects, starting on a cache line
+     */
+    pointer allocate (size_type n, const void* = 0) {
+        return static_cast<pointer>(arena->allocate(n * sizeof(T), node));
+    }
+
+    // ----------
+    // deallocate
+    // ----------
+
+    /**
+     * @param   p room from allocate(n)
+     * @param   n the same n
+     */
+    void deallocate (pointer p, size_type n) {
+        arena->deallocate(p, n * sizeof(T));
+    }
+
+    // ---------
+    // construct
+    // ---------
+
+    template <typename U, typename... Args>
+    void construct (U* p, Args&&... args) {
+        new (p) U(std::forward<Args>(args)...);
+    }
+
+    // -------
+    // destroy
+    // -------
+
+    template <typename U>
+    void destroy (U* p) {
+        p->~U();
+    }
+
+    // --------
+    // get_node
+    // --------
+
+    /**
+     * @return  the node rows are placed on, or NUMA_LOCAL
+     */
+    int get_node () const {
+        return node;
+    }
+
+    // --------
+    // max_size
+    // --------
+
+    size_type max_size () const {
+        return size_type(-1) / sizeof(T);
+    }
+};
+
+#endif // NumaAllocator_h
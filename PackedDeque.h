@@ -0,0 +1,666 @@
+// ----------------------------
+// projects/deque/PackedDeque.h
+// Copyright (C) 2014
+// Taylor Gregston
+// ----------------------------
+
+#ifndef PackedDeque_h
+#define PackedDeque_h
+
+// --------
+// includes
+// --------
+
+#include <algorithm>   // copy, copy_backward, fill, max, min
+#include <cassert>     // assert
+#include <cstddef>     // size_t
+#include <iterator>    // bidirectional_iterator_tag
+#include <memory>      // allocator
+#include <stdexcept>   // out_of_range
+#include <type_traits> // is_integral, is_same, make_signed, make_unsigned
+
+#include "Deque.h"
+
+// -------
+// defines
+// -------
+
+/**
+ * Rows of a packed_deque hold PACKED_ROW_SIZE values. A full row that is at least
+ * PACKED_HOT_ROWS rows away from both ends is cold, and is stored as its first value plus
+ * the differences between neighbours, less the smallest difference, in the fewest bits that
+ * hold the largest of them. The header of a packed row is PACKED_HEADER words.
+ */
+
+#define PACKED_ROW_SHIFT    8   // THIS VALUE MUST BE == log2(PACKED_ROW_SIZE)
+#define PACKED_ROW_SIZE     256 // THIS VALUE MUST BE == 2^PACKED_ROW_SHIFT
+#define PACKED_ROW_MASK     255 // THIS VALUE MUST BE == PACKED_ROW_SIZE - 1
+#define PACKED_HOT_ROWS     2   // rows kept unpacked at each end
+#define PACKED_HEADER       3   // first value, smallest difference, bit width
+
+// ------------
+// packed_deque
+// ------------
+
+/**
+ * A deque of integers whose cold interior rows are kept delta and frame-of-reference
+ * packed, for long histories of nearly sequential values such as timestamps and ids.
+ * Reads through operator[] and iterators return values, decoding a packed row into a
+ * one-row cache on first touch, so a scan decodes each row once. set() unpacks the row it
+ * writes to; compress_cold() packs such rows again. A row is only kept packed when that
+ * is smaller. Reads share the cache, so a packed_deque is not safe to read from two
+ * threads at once.
+ */
+template < typename T, typename A = std::allocator<T> >
+class packed_deque {
+public:
+    // --------
+    // typedefs
+    // --------
+
+    typedef A                                        allocator_type;
+    typedef typename allocator_type::value_type      value_type;
+
+    typedef typename allocator_type::size_type       size_type;
+    typedef typename allocator_type::difference_type difference_type;
+
+    static_assert(std::is_integral<T>::value && !std::is_same<T, bool>::value,
+                  "packed_deque needs an integral value_type");
+
+private:
+    typedef typename std::make_unsigned<T>::type word_type; //differences wrap in here
+    typedef typename std::make_signed<T>::type   signed_type;
+
+    struct packed_row {
+        T* raw;                         //PACKED_ROW_SIZE values, or 0 when packed
+        unsigned long long* packed;     //header and bits, or 0 when raw
+        size_t words;                   //words in packed
+    };
+
+    // ----
+    // data
+    // ----
+
+    allocator_type _a;      //the row allocator
+    typename A::template rebind<unsigned long long>::other _aw; //the packed row allocator
+    typename A::template rebind<packed_row>::other _ap;         //the map allocator
+    packed_row* deque_root; //row slots
+    size_t row_count;       //slots in deque_root
+    size_t begin_index;     //absolute index of the first value
+    size_t end_index;       //absolute index past the last value
+    mutable T cache[PACKED_ROW_SIZE];   //the last packed row read
+    mutable size_t cache_row;           //its slot, row_count when nothing is cached
+
+private:
+    // -----
+    // valid
+    // -----
+
+    bool valid () const {
+        return (begin_index <= end_index) && (end_index <= (row_count << PACKED_ROW_SHIFT));
+    }
+
+    packed_deque (const packed_deque&);
+    packed_deque& operator = (const packed_deque&);
+
+    static unsigned long long low_mask (unsigned width) {
+        return width >= 64 ? ~0ULL : (1ULL << width) - 1;
+    }
+
+    /**
+     * pack row r in place if it is raw and packing makes it smaller
+     * @return  true if the row is packed afterwards
+     */
+    bool pack (size_t r) {
+        packed_row& p = deque_root[r];
+        if(!p.raw)
+            return p.packed;
+        const T* v = p.raw;
+        word_type m = word_type(v[1]) - word_type(v[0]);
+        for(size_t k = 2; k < PACKED_ROW_SIZE; ++k) {
+            word_type d = word_type(v[k]) - word_type(v[k - 1]);
+            if(signed_type(d) < signed_type(m))
+                m = d;
+        }
+        unsigned long long bits = 0;
+        for(size_t k = 1; k < PACKED_ROW_SIZE; ++k)
+            bits |= word_type(word_type(v[k]) - word_type(v[k - 1]) - m);
+        unsigned width = bits ? 64 - __builtin_clzll(bits) : 0;
+
+        size_t words = PACKED_HEADER + ((PACKED_ROW_SIZE - 1) * width + 63) / 64;
+        if(words * sizeof(unsigned long long) >= PACKED_ROW_SIZE * sizeof(T))
+            return false;
+
+        unsigned long long* w = _aw.allocate(words);
+        std::fill(w, w + words, 0ULL);
+        w[0] = word_type(v[0]);
+        w[1] = m;
+        w[2] = width;
+        unsigned long long* out = w + PACKED_HEADER;
+        for(size_t k = 1; width && k < PACKED_ROW_SIZE; ++k) {
+            unsigned long long x = word_type(word_type(v[k]) - word_type(v[k - 1]) - m);
+            size_t at = (k - 1) * width;
+            size_t sh = at & 63;
+            out[at >> 6] |= x << sh;
+            if(sh + width > 64)
+                out[(at >> 6) + 1] |= x >> (64 - sh);
+        }
+        _a.deallocate(p.raw, PACKED_ROW_SIZE);
+        p.raw = NULL;
+        p.packed = w;
+        p.words = words;
+        return true;
+    }
+
+    /**
+     * decode packed row p into out
+     */
+    static void unpack (const packed_row& p, T* out) {
+        const unsigned long long* w = p.packed;
+        word_type v = word_type(w[0]);
+        word_type m = word_type(w[1]);
+        unsigned width = unsigned(w[2]);
+        unsigned long long mask = low_mask(width);
+        const unsigned long long* in = w + PACKED_HEADER;
+        out[0] = T(v);
+        for(size_t k = 1; k < PACKED_ROW_SIZE; ++k) {
+            unsigned long long x = 0;
+            if(width) {
+                size_t at = (k - 1) * width;
+                size_t sh = at & 63;
+                x = in[at >> 6] >> sh;
+                if(sh + width > 64)
+                    x |= in[(at >> 6) + 1] << (64 - sh);
+                x &= mask;
+            }
+            v = word_type(v + word_type(x) + m);
+            out[k] = T(v);
+        }
+    }
+
+    /**
+     * turn row r back into raw values so it can be written
+     */
+    void inflate (size_t r) {
+        packed_row& p = deque_root[r];
+        if(!p.packed)
+            return;
+        T* raw = _a.allocate(PACKED_ROW_SIZE);
+        unpack(p, raw);
+        _aw.deallocate(p.packed, p.words);
+        p.packed = NULL;
+        p.words = 0;
+        p.raw = raw;
+        if(cache_row == r)
+            cache_row = row_count;
+    }
+
+    /**
+     * make sure the row holding value i exists and is raw
+     */
+    void touch_row (size_t i) {
+        size_t r = i >> PACKED_ROW_SHIFT;
+        if(deque_root[r].packed)
+            inflate(r);
+        else if(!deque_root[r].raw)
+            deque_root[r].raw = _a.allocate(PACKED_ROW_SIZE);
+    }
+
+    void free_row (size_t r) {
+        packed_row& p = deque_root[r];
+        if(p.raw)
+            _a.deallocate(p.raw, PACKED_ROW_SIZE);
+        if(p.packed)
+            _aw.deallocate(p.packed, p.words);
+        p.raw = NULL;
+        p.packed = NULL;
+        p.words = 0;
+        if(cache_row == r)
+            cache_row = row_count;
+    }
+
+    /**
+     * @return  true if row r is full and at least PACKED_HOT_ROWS rows from both ends
+     */
+    bool cold (size_t r) const {
+        size_t first = begin_index >> PACKED_ROW_SHIFT;
+        size_t last = end_index >> PACKED_ROW_SHIFT;
+        return (r >= first + PACKED_HOT_ROWS) && (r + PACKED_HOT_ROWS <= last) &&
+               (r << PACKED_ROW_SHIFT) >= begin_index;
+    }
+
+    /**
+     * make room for add more rows at one end of the map. when the live rows take up
+     * less than half of the map they are slid to the middle, otherwise the map doubles
+     * @param   add the number of row slots needed past the live rows
+     * @param   at_front true to make the room in front of begin, false after end
+     */
+    void reserve_rows (size_t add, bool at_front) {
+        size_t first = begin_index >> PACKED_ROW_SHIFT;
+        size_t last = std::min(row_count, std::max(first + 1, (end_index + PACKED_ROW_SIZE - 1) >> PACKED_ROW_SHIFT));
+        size_t live = last - first;
+        size_t need = live + add;
+        packed_row none = {NULL, NULL, 0};
+
+        for(size_t i = 0; i < row_count; ++i)
+            if(i < first || i >= last)
+                free_row(i);
+
+        size_t new_count = row_count;
+        if(2 * need > row_count)
+            new_count = std::max(2 * row_count, 2 * need);
+        size_t new_first = (new_count - need) / 2 + (at_front ? add : 0);
+
+        if(new_count == row_count && new_first > first) {
+            std::copy_backward(deque_root + first, deque_root + last, deque_root + new_first + live);
+            std::fill(deque_root + first, deque_root + std::min(new_first, last), none);
+        }
+        else if(new_count == row_count && new_first < first) {
+            std::copy(deque_root + first, deque_root + last, deque_root + new_first);
+            std::fill(deque_root + std::max(new_first + live, first), deque_root + last, none);
+        }
+        else if(new_count != row_count) {
+            packed_row* new_root = _ap.allocate(new_count);
+            std::fill(new_root, new_root + new_count, none);
+            if(deque_root) {
+                std::copy(deque_root + first, deque_root + last, new_root + new_first);
+                _ap.deallocate(deque_root, row_count);
+            }
+            deque_root = new_root;
+            row_count = new_count;
+        }
+
+        size_t shift = (new_first << PACKED_ROW_SHIFT) - (first << PACKED_ROW_SHIFT);
+        begin_index += shift;
+        end_index += shift;
+        cache_row = row_count;
+        assert(valid());
+    }
+
+    /**
+     * @return  the value at absolute index i
+     */
+    T get (size_t i) const {
+        size_t r = i >> PACKED_ROW_SHIFT;
+        const packed_row& p = deque_root[r];
+        if(p.raw)
+            return p.raw[i & PACKED_ROW_MASK];
+        if(cache_row != r) {
+            unpack(p, cache);
+            cache_row = r;
+        }
+        return cache[i & PACKED_ROW_MASK];
+    }
+
+public:
+    // --------------
+    // const_iterator
+    // --------------
+
+    class const_iterator {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef std::bidirectional_iterator_tag        iterator_category;
+        typedef typename packed_deque::value_type      value_type;
+        typedef typename packed_deque::difference_type difference_type;
+        typedef const value_type*                      pointer;
+        typedef value_type                             reference;
+
+    public:
+        /**
+         * checks to see if the lhs == rhs
+         * @param   lhs the left hand side in question
+         * @param   rhs the right hand side in question
+         * @return  true if the lhs and rhs point to the same value
+         */
+        friend bool operator == (const const_iterator& lhs, const const_iterator& rhs) {
+            return lhs.index == rhs.index;
+        }
+
+        /**
+         * checks to see if the lhs != rhs
+         * @param   lhs the left hand side in question
+         * @param   rhs the right hand side in question
+         * @return  false if the lhs and rhs point to the same value
+         */
+        friend bool operator != (const const_iterator& lhs, const const_iterator& rhs) {
+            return !(lhs == rhs);
+        }
+
+    private:
+        // ----
+        // data
+        // ----
+
+        const packed_deque* owner;
+        size_t index;   //absolute index
+
+    public:
+        /**
+         * creates an iterator at absolute index index_
+         * @param   owner_ the underlying container
+         * @param   index_ the absolute index
+         */
+        const_iterator (const packed_deque* owner_, size_t index_) :
+        owner(owner_), index(index_)
+        {}
+
+        /**
+         * dereference this iterator, decoding its row if it is packed
+         * @returns the value at which this iterator is pointing
+         */
+        reference operator * () const {
+            return owner->get(index);
+        }
+
+        /**
+         * increment (pre) this iterator by one
+         * @returns iterator with its NEW value
+         */
+        const_iterator& operator ++ () {
+            ++index;
+            return *this;
+        }
+
+        /**
+         * increment (post) this iterator by one
+         * @returns iterator with its OLD value
+         */
+        const_iterator operator ++ (int) {
+            const_iterator x = *this;
+            ++(*this);
+            return x;
+        }
+
+        /**
+         * decrement (pre) this iterator by one
+         * @returns iterator with its NEW value
+         */
+        const_iterator& operator -- () {
+            --index;
+            return *this;
+        }
+
+        /**
+         * decrement (post) this iterator by one
+         * @returns iterator with its OLD value
+         */
+        const_iterator operator -- (int) {
+            const_iterator x = *this;
+            --(*this);
+            return x;
+        }
+    };
+
+public:
+    // ------------
+    // constructors
+    // ------------
+
+    /**
+     * create an empty packed_deque
+     * @param   a the allocator to be used for this deque
+     */
+    explicit packed_deque (const allocator_type& a = allocator_type()) :
+    _a(a), _aw(a), _ap(a), deque_root(NULL), row_count(0), begin_index(0), end_index(0), cache_row(0)
+    {}
+
+    // ----------
+    // destructor
+    // ----------
+
+    /**
+     * free every row and the map
+     */
+    ~packed_deque () {
+        clear();
+    }
+
+    // -----------
+    // operator []
+    // -----------
+
+    /**
+     * index this deque, decoding the row if it is packed
+     * @param index the index in this deque to be evaluated
+     * @return the value at index
+     */
+    value_type operator [] (size_type index) const {
+        return get(begin_index + index);
+    }
+
+    // --
+    // at
+    // --
+
+    /**
+     * index this deque
+     * @param index the index in this deque to be evaluated
+     * @return the value at index
+     * @throws out_of_range if the index is greater or equal to size
+     */
+    value_type at (size_type index) const {
+        if(index >= size())
+            throw std::out_of_range("at index out of range");
+        return (*this)[index];
+    }
+
+    // -----
+    // front
+    // -----
+
+    /**
+     * @returns the value at the front of the deque
+     */
+    value_type front () const {
+        return get(begin_index);
+    }
+
+    // ----
+    // back
+    // ----
+
+    /**
+     * @returns the value at the back of the deque
+     */
+    value_type back () const {
+        return get(end_index - 1);
+    }
+
+    // -----
+    // begin
+    // -----
+
+    /**
+     * @returns an iterator pointing to the first value
+     */
+    const_iterator begin () const {
+        return const_iterator(this, begin_index);
+    }
+
+    // ---
+    // end
+    // ---
+
+    /**
+     * @returns an iterator pointing past the last value
+     */
+    const_iterator end () const {
+        return const_iterator(this, end_index);
+    }
+
+    // -----
+    // bytes
+    // -----
+
+    /**
+     * @returns the bytes held by rows and the map
+     */
+    size_type bytes () const {
+        size_type n = row_count * sizeof(packed_row);
+        for(size_t r = 0; r < row_count; ++r) {
+            if(deque_root[r].raw)
+                n += PACKED_ROW_SIZE * sizeof(T);
+            n += deque_root[r].words * sizeof(unsigned long long);
+        }
+        return n;
+    }
+
+    // -----
+    // clear
+    // -----
+
+    /**
+     * drop every value and free every row and the map
+     */
+    void clear () {
+        for(size_t r = 0; r < row_count; ++r)
+            free_row(r);
+        if(deque_root)
+            _ap.deallocate(deque_root, row_count);
+        deque_root = NULL;
+        row_count = 0;
+        begin_index = end_index = 0;
+        cache_row = 0;
+    }
+
+    // -------------
+    // compress_cold
+    // -------------
+
+    /**
+     * pack every cold row that is still raw, for instance after set()
+     * @return  the number of rows packed
+     */
+    size_type compress_cold () {
+        size_type n = 0;
+        for(size_t r = begin_index >> PACKED_ROW_SHIFT; r < (end_index >> PACKED_ROW_SHIFT); ++r)
+            if(deque_root[r].raw && cold(r) && pack(r))
+                ++n;
+        return n;
+    }
+
+    // -----
+    // empty
+    // -----
+
+    /**
+     * @returns true if size == 0
+     */
+    bool empty () const {
+        return begin_index == end_index;
+    }
+
+    // -----------
+    // packed_rows
+    // -----------
+
+    /**
+     * @returns the number of rows stored packed
+     */
+    size_type packed_rows () const {
+        size_type n = 0;
+        for(size_t r = 0; r < row_count; ++r)
+            n += deque_root[r].packed != NULL;
+        return n;
+    }
+
+    // ---
+    // pop
+    // ---
+
+    /**
+     * removes the value at the back of the deque, freeing the row it leaves
+     */
+    void pop_back () {
+        assert(!empty());
+        --end_index;
+        if(!(end_index & PACKED_ROW_MASK))
+            free_row(end_index >> PACKED_ROW_SHIFT);
+        assert(valid());
+    }
+
+    /**
+     * removes the value at the front of the deque, freeing the row it leaves
+     */
+    void pop_front () {
+        assert(!empty());
+        ++begin_index;
+        if(!(begin_index & PACKED_ROW_MASK))
+            free_row((begin_index >> PACKED_ROW_SHIFT) - 1);
+        assert(valid());
+    }
+
+    // ----
+    // push
+    // ----
+
+    /**
+     * push a value onto the back side of this deque. starting a new row packs the row
+     * PACKED_HOT_ROWS behind it
+     * @param val the value to add to the deque
+     */
+    void push_back (const value_type& val) {
+        if(end_index == (row_count << PACKED_ROW_SHIFT))
+            reserve_rows(1, false);
+        touch_row(end_index);
+        deque_root[end_index >> PACKED_ROW_SHIFT].raw[end_index & PACKED_ROW_MASK] = val;
+        ++end_index;
+        if(!(end_index & PACKED_ROW_MASK)) {
+            size_t r = end_index >> PACKED_ROW_SHIFT;
+            if(r >= PACKED_HOT_ROWS && cold(r - PACKED_HOT_ROWS))
+                pack(r - PACKED_HOT_ROWS);
+        }
+        assert(valid());
+    }
+
+    /**
+     * push a value onto the front side of this deque. starting a new row packs the row
+     * PACKED_HOT_ROWS ahead of it
+     * @param val the value to add to the deque
+     */
+    void push_front (const value_type& val) {
+        if(!begin_index)
+            reserve_rows(1, true);
+        touch_row(begin_index - 1);
+        --begin_index;
+        deque_root[begin_index >> PACKED_ROW_SHIFT].raw[begin_index & PACKED_ROW_MASK] = val;
+        if(!(begin_index & PACKED_ROW_MASK)) {
+            size_t r = (begin_index >> PACKED_ROW_SHIFT) + PACKED_HOT_ROWS;
+            if(r < row_count && cold(r))
+                pack(r);
+        }
+        assert(valid());
+    }
+
+    // ---
+    // set
+    // ---
+
+    /**
+     * overwrite the value at index, unpacking its row if needed
+     * @param index the index in this deque
+     * @param val the new value
+     */
+    void set (size_type index, const value_type& val) {
+        size_t i = begin_index + index;
+        touch_row(i);
+        deque_root[i >> PACKED_ROW_SHIFT].raw[i & PACKED_ROW_MASK] = val;
+    }
+
+    // ----
+    // size
+    // ----
+
+    /**
+     * @returns the number of values in this deque
+     */
+    size_type size () const {
+        return end_index - begin_index;
+    }
+};
+
+#endif // PackedDeque_h
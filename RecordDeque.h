@@ -0,0 +1,427 @@
+// ----------------------------
+// projects/deque/RecordDeque.h
+// Copyright (C) 2014
+// Taylor Gregston
+// ----------------------------
+
+#ifndef RecordDeque_h
+#define RecordDeque_h
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // copy, fill, max
+#include <cassert>   // assert
+#include <cstddef>   // size_t
+#include <cstring>   // memcpy
+#include <iterator>  // forward_iterator_tag
+#include <memory>    // allocator
+#include <stdexcept> // length_error
+
+#include "Deque.h"   // row_span
+
+// -------
+// defines
+// -------
+
+/**
+ * A record_deque packs records into byte rows of RECORD_ROW_SIZE. Each record is a
+ * RECORD_PREFIX byte length followed by its bytes, padded so the next record starts on a
+ * multiple of RECORD_PREFIX. A record that does not fit in what is left of a row starts
+ * the next row instead, behind a RECORD_PAD marker, so every record stays contiguous.
+ */
+
+#define RECORD_ROW_SHIFT    16      // THIS VALUE MUST BE == log2(RECORD_ROW_SIZE)
+#define RECORD_ROW_SIZE     65536   // THIS VALUE MUST BE == 2^RECORD_ROW_SHIFT
+#define RECORD_ROW_MASK     65535   // THIS VALUE MUST BE == RECORD_ROW_SIZE - 1
+#define RECORD_PREFIX       4       // bytes in the length prefix
+#define RECORD_PAD          0xFFFFFFFFu // length prefix marking the rest of a row unused
+
+// ------------
+// record_deque
+// ------------
+
+/**
+ * A queue of variable length byte records stored back to back in large rows instead of
+ * one heap block per record.
+ * front() and iteration hand out row_spans that point straight into the rows, valid until
+ * that record is popped. Rows are freed as pop_front leaves them, and the map of rows is
+ * slid back to the start or doubled as it fills, the same way soa_deque manages its map.
+ */
+template < typename A = std::allocator<char> >
+class record_deque {
+public:
+    // --------
+    // typedefs
+    // --------
+
+    typedef A                       allocator_type;
+    typedef row_span<const char>    value_type;
+    typedef size_t                  size_type;
+
+private:
+    // ----
+    // data
+    // ----
+
+    allocator_type _a;  //the row allocator
+    typename A::template rebind<char*>::other _ap; //the map allocator
+    char** deque_root;  //row slots, 0 where no row is allocated
+    size_t row_count;   //slots in deque_root
+    size_t begin_index; //byte position of the first record
+    size_t end_index;   //byte position past the last record
+    size_t deque_size;  //how many records
+
+private:
+    // -----
+    // valid
+    // -----
+
+    bool valid () const {
+        return (begin_index <= end_index) && (end_index <= (row_count << RECORD_ROW_SHIFT)) &&
+               (!deque_size == (begin_index == end_index)) && !(end_index % RECORD_PREFIX);
+    }
+
+    record_deque (const record_deque&);
+    record_deque& operator = (const record_deque&);
+
+    /**
+     * @param   n the bytes of a record
+     * @return  the bytes the record takes up in a row, prefix and padding included
+     */
+    static size_t footprint (size_t n) {
+        return (RECORD_PREFIX + n + RECORD_PREFIX - 1) & ~size_t(RECORD_PREFIX - 1);
+    }
+
+    /**
+     * @param   i a byte position
+     * @return  the length prefix stored at i
+     */
+    unsigned prefix (size_t i) const {
+        unsigned n;
+        std::memcpy(&n, deque_root[i >> RECORD_ROW_SHIFT] + (i & RECORD_ROW_MASK), RECORD_PREFIX);
+        return n;
+    }
+
+    /**
+     * @param   i the byte position of a record
+     * @return  the byte position of the record after it, past any padding
+     */
+    size_t next (size_t i) const {
+        i += footprint(prefix(i));
+        if((i != end_index) && (i & RECORD_ROW_MASK) && (prefix(i) == RECORD_PAD))
+            i = ((i >> RECORD_ROW_SHIFT) + 1) << RECORD_ROW_SHIFT;
+        return i;
+    }
+
+    /**
+     * @return  a view of the record at byte position i
+     */
+    value_type view (size_t i) const {
+        value_type x = {deque_root[i >> RECORD_ROW_SHIFT] + (i & RECORD_ROW_MASK) + RECORD_PREFIX, prefix(i)};
+        return x;
+    }
+
+    /**
+     * make room for add more rows after end. when the live rows take up less than half
+     * of the map they are slid to the start, otherwise the map doubles
+     * @param   add the number of row slots needed past the live rows
+     */
+    void reserve_rows (size_t add) {
+        size_t first = begin_index >> RECORD_ROW_SHIFT;
+        size_t last = std::max(first, (end_index + RECORD_ROW_SIZE - 1) >> RECORD_ROW_SHIFT);
+        size_t live = last - first;
+        size_t need = live + add;
+
+        if(2 * need <= row_count) {
+            if(!first)
+                return;
+            std::copy(deque_root + first, deque_root + last, deque_root);
+            std::fill(deque_root + std::max(live, first), deque_root + last, (char*)0);
+        }
+        else {
+            size_t new_count = std::max(2 * row_count, 2 * need);
+            char** new_root = _ap.allocate(new_count);
+            std::fill(new_root, new_root + new_count, (char*)0);
+            std::copy(deque_root + first, deque_root + last, new_root);
+            if(deque_root)
+                _ap.deallocate(deque_root, row_count);
+            deque_root = new_root;
+            row_count = new_count;
+        }
+
+        size_t shift = first << RECORD_ROW_SHIFT;
+        begin_index -= shift;
+        end_index -= shift;
+        assert(valid());
+    }
+
+    /**
+     * make sure the row holding byte position i exists
+     */
+    void touch_row (size_t i) {
+        char*& r = deque_root[i >> RECORD_ROW_SHIFT];
+        if(!r)
+            r = _a.allocate(RECORD_ROW_SIZE);
+    }
+
+public:
+    // --------------
+    // const_iterator
+    // --------------
+
+    class const_iterator {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef std::forward_iterator_tag    iterator_category;
+        typedef typename record_deque::value_type value_type;
+        typedef std::ptrdiff_t               difference_type;
+        typedef const value_type*            pointer;
+        typedef value_type                   reference;
+
+    public:
+        /**
+         * checks to see if the lhs == rhs
+         * @param   lhs the left hand side in question
+         * @param   rhs the right hand side in question
+         * @return  true if the lhs and rhs point to the same record
+         */
+        friend bool operator == (const const_iterator& lhs, const const_iterator& rhs) {
+            return lhs.index == rhs.index;
+        }
+
+        /**
+         * checks to see if the lhs != rhs
+         * @param   lhs the left hand side in question
+         * @param   rhs the right hand side in question
+         * @return  false if the lhs and rhs point to the same record
+         */
+        friend bool operator != (const const_iterator& lhs, const const_iterator& rhs) {
+            return !(lhs == rhs);
+        }
+
+    private:
+        // ----
+        // data
+        // ----
+
+        const record_deque* owner;
+        size_t index;   //byte position of the record
+
+    public:
+        /**
+         * creates an iterator at byte position index_
+         * @param   owner_ the underlying container
+         * @param   index_ the byte position
+         */
+        const_iterator (const record_deque* owner_, size_t index_) :
+        owner(owner_), index(index_)
+        {}
+
+        /**
+         * dereference this iterator
+         * @returns a view of the record, pointing into the row
+         */
+        reference operator * () const {
+            return owner->view(index);
+        }
+
+        /**
+         * increment (pre) this iterator to the next record
+         * @returns iterator with its NEW value
+         */
+        const_iterator& operator ++ () {
+            index = owner->next(index);
+            return *this;
+        }
+
+        /**
+         * increment (post) this iterator to the next record
+         * @returns iterator with its OLD value
+         */
+        const_iterator operator ++ (int) {
+            const_iterator x = *this;
+            ++(*this);
+            return x;
+        }
+    };
+
+public:
+    // ------------
+    // constructors
+    // ------------
+
+    /**
+     * create an empty record_deque
+     * @param   a the allocator to be used for the rows
+     */
+    explicit record_deque (const allocator_type& a = allocator_type()) :
+    _a(a), _ap(a), deque_root(NULL), row_count(0), begin_index(0), end_index(0), deque_size(0)
+    {}
+
+    // ----------
+    // destructor
+    // ----------
+
+    /**
+     * free every row and the map
+     */
+    ~record_deque () {
+        clear();
+    }
+
+    // -----
+    // begin
+    // -----
+
+    /**
+     * @returns an iterator pointing to the first record
+     */
+    const_iterator begin () const {
+        return const_iterator(this, begin_index);
+    }
+
+    // -----
+    // bytes
+    // -----
+
+    /**
+     * @returns the bytes of the rows between the first and the last record, including
+     *          prefixes and padding
+     */
+    size_type bytes () const {
+        return end_index - begin_index;
+    }
+
+    // -----
+    // clear
+    // -----
+
+    /**
+     * drop every record and free every row and the map
+     */
+    void clear () {
+        for(size_t i = 0; i < row_count; ++i)
+            if(deque_root[i])
+                _a.deallocate(deque_root[i], RECORD_ROW_SIZE);
+        if(deque_root)
+            _ap.deallocate(deque_root, row_count);
+        deque_root = NULL;
+        row_count = 0;
+        begin_index = end_index = deque_size = 0;
+    }
+
+    // -----
+    // empty
+    // -----
+
+    /**
+     * @returns true if size == 0
+     */
+    bool empty () const {
+        return !deque_size;
+    }
+
+    // ---
+    // end
+    // ---
+
+    /**
+     * @returns an iterator pointing past the last record
+     */
+    const_iterator end () const {
+        return const_iterator(this, end_index);
+    }
+
+    // -----
+    // front
+    // -----
+
+    /**
+     * @returns a view of the oldest record, pointing into its row. no bytes are copied
+     */
+    value_type front () const {
+        assert(!empty());
+        return view(begin_index);
+    }
+
+    // ---------
+    // pop_front
+    // ---------
+
+    /**
+     * drop the oldest record, freeing any row it was the last one in
+     */
+    void pop_front () {
+        assert(!empty());
+        size_t row = begin_index >> RECORD_ROW_SHIFT;
+        begin_index = next(begin_index);
+        --deque_size;
+        for(; row < (begin_index >> RECORD_ROW_SHIFT); ++row) {
+            _a.deallocate(deque_root[row], RECORD_ROW_SIZE);
+            deque_root[row] = NULL;
+        }
+        assert(valid());
+    }
+
+    // ---------
+    // push_back
+    // ---------
+
+    /**
+     * copy a record onto the back, amortized O(length)
+     * @param   r the bytes of the record
+     * @throws  length_error if the record cannot fit in one row
+     */
+    void push_back (row_span<const char> r) {
+        if(r.length > RECORD_ROW_SIZE - RECORD_PREFIX)
+            throw std::length_error("record_deque record larger than a row");
+        size_t n = footprint(r.length);
+        size_t left = RECORD_ROW_SIZE - (end_index & RECORD_ROW_MASK);
+        if(!deque_size)
+            begin_index = end_index = end_index & ~size_t(RECORD_ROW_MASK); //reuse the row from its start
+        else if((end_index & RECORD_ROW_MASK) && (n > left)) {
+            unsigned pad = RECORD_PAD;
+            std::memcpy(deque_root[end_index >> RECORD_ROW_SHIFT] + (end_index & RECORD_ROW_MASK), &pad, RECORD_PREFIX);
+            end_index += left;
+        }
+        if(end_index == (row_count << RECORD_ROW_SHIFT))
+            reserve_rows(1);
+        touch_row(end_index);
+
+        unsigned length = r.length;
+        char* p = deque_root[end_index >> RECORD_ROW_SHIFT] + (end_index & RECORD_ROW_MASK);
+        std::memcpy(p, &length, RECORD_PREFIX);
+        std::memcpy(p + RECORD_PREFIX, r.data, r.length);
+        end_index += n;
+        ++deque_size;
+        assert(valid());
+    }
+
+    /**
+     * copy a record onto the back
+     * @param   p the first byte of the record
+     * @param   n the number of bytes
+     */
+    void push_back (const char* p, size_t n) {
+        row_span<const char> r = {p, n};
+        push_back(r);
+    }
+
+    // ----
+    // size
+    // ----
+
+    /**
+     * @returns the number of records
+     */
+    size_type size () const {
+        return deque_size;
+    }
+};
+
+#endif // RecordDeque_h
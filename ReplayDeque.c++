@@ -0,0 +1,153 @@
+// ------------------------------
+// projects/deque/ReplayDeque.c++
+// Copyright (C) 2014
+// Taylor Gregston
+// ------------------------------
+
+/*
+To compile the driver:
+    % g++-4.7 -pedantic -std=c++11 -O3 -Wall ReplayDeque.c++ -o ReplayDeque
+
+To record a synthetic trace:
+    % ReplayDeque -record trace_file [calls]
+
+To replay a trace:
+    % ReplayDeque trace_file
+
+Replays a trace written by a trace_writer, from a recording_deque or from -record, against
+my_deque and std::deque of long long, both on a counting_allocator. Each is run twice: once
+straight through for throughput, allocations and peak memory, and once with every call
+timed for the latency percentiles, less the cost of reading the clock.
+The trace is decoded before either run, and it is assumed to be valid, as a recorded trace
+is: it pops, reads, inserts and erases only where there are values.
+*/
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // nth_element, max
+#include <chrono>    // steady_clock
+#include <cstdlib>   // atol
+#include <cstring>   // strcmp
+#include <deque>     // deque
+#include <fstream>   // ifstream, ofstream
+#include <iostream>  // cout, cerr, endl
+#include <vector>    // vector
+
+#include "CountingAllocator.h"
+#include "Deque.h"
+#include "DequeTrace.h"
+
+// ------
+// record
+// ------
+
+/**
+ * write a synthetic mix through a recording_deque: mostly push_back, pop_front and
+ * operator[], with some push_front, pop_back, insert and erase, the size wandering
+ * between 0 and a few hundred thousand
+ */
+void record (const char* file, size_t calls) {
+    std::ofstream out(file, std::ios::binary);
+    trace_writer w(out);
+    recording_deque<long long> x(w);
+    unsigned r = 42;
+    size_t target = 1000;
+    for(size_t i = 0; i < calls; ++i) {
+        r = r * 1103515245 + 12345;
+        unsigned c = (r >> 16) % 100;
+        if(!(i % 65536)) {
+            r = r * 1103515245 + 12345;
+            target = 1 + (r >> 8) % 300000;
+        }
+        if(x.size() && (c < 30))
+            x[(r >> 4) % x.size()];
+        else if(x.size() && (c < 32)) {
+            if((r >> 4) & 1)
+                x.insert(x.begin() + (r >> 5) % x.size(), i);
+            else
+                x.erase(x.begin() + (r >> 5) % x.size());
+        }
+        else if(x.size() > target)
+            ((c < 90) ? x.pop_front() : x.pop_back());
+        else
+            ((c < 90) ? x.push_back(i) : x.push_front(-(long long)i));
+    }
+    std::cout << "recorded " << calls << " calls to " << file << std::endl;
+}
+
+// ------
+// replay
+// ------
+
+/**
+ * replay ops against a D made with a counting_allocator and report on it
+ */
+template <typename D>
+void replay (const char* name, const std::vector<trace_op>& ops) {
+    using namespace std::chrono;
+    const size_t n = ops.size();
+    long long sum = 0;
+
+    allocation_stats::reset();
+    const size_t live = allocation_stats::get().live;
+    steady_clock::time_point t = steady_clock::now();
+    {
+        D x;
+        for(size_t i = 0; i < n; ++i)
+            sum += trace_apply(x, ops[i]);
+    }
+    duration<double> s = steady_clock::now() - t;
+    const size_t allocations = allocation_stats::get().allocations;
+    const size_t peak = allocation_stats::get().peak - live;
+
+    steady_clock::time_point a = steady_clock::now();
+    for(int i = 0; i < 1000; ++i)
+        steady_clock::now();
+    const double clock = duration<double, std::nano>(steady_clock::now() - a).count() / 1001;
+    std::vector<double> ns(n);
+    {
+        D x;
+        for(size_t i = 0; i < n; ++i) {
+            steady_clock::time_point b = steady_clock::now();
+            sum += trace_apply(x, ops[i]);
+            ns[i] = std::max(0.0, duration<double, std::nano>(steady_clock::now() - b).count() - clock);
+        }
+    }
+    double p[3] = {0.5, 0.99, 0.999};
+    for(int i = 0; (i < 3) && n; ++i) {
+        std::nth_element(ns.begin(), ns.begin() + size_t(p[i] * (n - 1)), ns.end());
+        p[i] = ns[size_t(p[i] * (n - 1))];
+    }
+
+    std::cout << name << n / s.count() << " calls/s, p50 " << p[0] << " ns, p99 " << p[1]
+              << " ns, p999 " << p[2] << " ns, " << allocations << " allocations, peak "
+              << peak << " bytes (" << sum << ")" << std::endl;
+}
+
+// ----
+// main
+// ----
+
+int main (int argc, char** argv) {
+    using namespace std;
+    if((argc > 2) && !strcmp(argv[1], "-record")) {
+        record(argv[2], (argc > 3) ? atol(argv[3]) : 10000000);
+        return 0;
+    }
+    if(argc != 2) {
+        cerr << "usage: ReplayDeque trace_file | ReplayDeque -record trace_file [calls]" << endl;
+        return 1;
+    }
+    ifstream in(argv[1], ios::binary);
+    if(!in) {
+        cerr << "ReplayDeque: cannot open " << argv[1] << endl;
+        return 1;
+    }
+    vector<trace_op> ops = read_trace(in);
+    cout << "calls: " << ops.size() << endl;
+    replay< my_deque<long long, counting_allocator<long long> > >("my_deque:   ", ops);
+    replay< deque<long long, counting_allocator<long long> > >("std::deque: ", ops);
+    return 0;
+}
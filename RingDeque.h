@@ -0,0 +1,332 @@
+// --------------------------
+// projects/deque/RingDeque.h
+// Copyright (C) 2014
+// Taylor Gregston
+// --------------------------
+
+#ifndef RingDeque_h
+#define RingDeque_h
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // min
+#include <cassert>   // assert
+#include <cstddef>   // size_t
+#include <memory>    // allocator
+#include <stdexcept> // invalid_argument, out_of_range
+
+#include "Deque.h"   // row_span, uninitialized_fill, destroy
+
+// ----------
+// ring_deque
+// ----------
+
+/**
+ * A fixed-capacity window over the most recent values.
+ * All capacity() slots are allocated and default constructed once, as a single row, when the
+ * ring is built; after that push_back just assigns into the slot of the oldest value, so the
+ * steady state has no allocation, no construction and no branch on whether a row is full.
+ * Index 0 is the oldest value and size() - 1 the newest.
+ * The capacity is N when N is non-zero, otherwise it is given to the constructor.
+ */
+template < typename T, size_t N = 0, typename A = std::allocator<T> >
+class ring_deque {
+public:
+    // --------
+    // typedefs
+    // --------
+
+    typedef A                                        allocator_type;
+    typedef typename allocator_type::value_type      value_type;
+
+    typedef typename allocator_type::size_type       size_type;
+    typedef typename allocator_type::difference_type difference_type;
+
+    typedef typename allocator_type::pointer         pointer;
+    typedef typename allocator_type::const_pointer   const_pointer;
+
+    typedef typename allocator_type::reference       reference;
+    typedef typename allocator_type::const_reference const_reference;
+
+private:
+    // ----
+    // data
+    // ----
+
+    allocator_type _a;    //the standard allocator
+    T* ring;              //the one row holding every slot
+    size_t ring_capacity; //slots in ring, only read when N == 0
+    size_t oldest;        //slot of index 0
+    size_t ring_size;     //how many values are in the window
+
+private:
+    // -----
+    // valid
+    // -----
+
+    bool valid () const {
+        return (oldest < capacity()) && (ring_size <= capacity());
+    }
+
+    /**
+     * @param   i a slot number below 2 * capacity()
+     * @return  i folded back into the ring, compiles to a conditional move
+     */
+    size_t wrap (size_t i) const {
+        return i >= capacity() ? i - capacity() : i;
+    }
+
+    ring_deque (const ring_deque&);
+    ring_deque& operator = (const ring_deque&);
+
+public:
+    // ------------
+    // constructors
+    // ------------
+
+    /**
+     * create an empty ring of capacity N, or of capacity c when N is 0
+     * @param   c the capacity, ignored when N is non-zero
+     * @param   a the allocator to be used for this ring
+     * @throws  invalid_argument if the capacity is 0
+     */
+    explicit ring_deque (size_type c = N, const allocator_type& a = allocator_type()) :
+    _a(a), ring(NULL), ring_capacity(N ? N : c), oldest(0), ring_size(0)
+    {
+        if(!capacity())
+            throw std::invalid_argument("ring_deque capacity must be positive");
+        ring = _a.allocate(capacity());
+        try {
+            uninitialized_fill(_a, ring, ring + capacity(), value_type());
+        }
+        catch (...) {
+            _a.deallocate(ring, capacity());
+            throw;}
+        assert(valid());
+    }
+
+    // ----------
+    // destructor
+    // ----------
+
+    /**
+     * destroy every slot and free the row
+     */
+    ~ring_deque () {
+        destroy(_a, ring, ring + capacity());
+        _a.deallocate(ring, capacity());
+    }
+
+    // -----------
+    // operator []
+    // -----------
+
+    /**
+     * index the window, oldest first
+     * @param index the index in this window to be evaluated
+     * @return a reference to the value at index
+     */
+    reference operator [] (size_type index) {
+        return ring[wrap(oldest + index)];
+    }
+
+    /**
+     * index the window, oldest first (read only)
+     * @param index the index in this window to be evaluated
+     * @return a reference to the value at index
+     */
+    const_reference operator [] (size_type index) const {
+        return const_cast<ring_deque*>(this)->operator[](index);
+    }
+
+    // --
+    // at
+    // --
+
+    /**
+     * index the window, oldest first
+     * @param index the index in this window to be evaluated
+     * @return a reference to the value at index
+     * @throws out_of_range if the index is greater or equal to size
+     */
+    reference at (size_type index) {
+        if(index >= ring_size)
+            throw std::out_of_range("at index out of range");
+        return (*this)[index];
+    }
+
+    /**
+     * index the window, oldest first (read only)
+     * @param index the index in this window to be evaluated
+     * @return a reference to the value at index
+     * @throws out_of_range if the index is greater or equal to size
+     */
+    const_reference at (size_type index) const {
+        return const_cast<ring_deque*>(this)->at(index);
+    }
+
+    // -----
+    // front
+    // -----
+
+    /**
+     * @returns the oldest value
+     */
+    reference front () {
+        return ring[oldest];
+    }
+
+    const_reference front () const {
+        return ring[oldest];
+    }
+
+    // ----
+    // back
+    // ----
+
+    /**
+     * @returns the newest value
+     */
+    reference back () {
+        return (*this)[ring_size - 1];
+    }
+
+    const_reference back () const {
+        return (*this)[ring_size - 1];
+    }
+
+    // --------
+    // capacity
+    // --------
+
+    /**
+     * @returns how many values the window holds before it starts overwriting
+     */
+    size_type capacity () const {
+        return N ? N : ring_capacity;
+    }
+
+    // -----
+    // clear
+    // -----
+
+    /**
+     * empty the window, the slots stay constructed
+     */
+    void clear () {
+        oldest = 0;
+        ring_size = 0;
+    }
+
+    // -----
+    // empty
+    // -----
+
+    /**
+     * @returns true if size == 0
+     */
+    bool empty () const {
+        return !ring_size;
+    }
+
+    // ----
+    // full
+    // ----
+
+    /**
+     * @returns true if the next push_back overwrites the oldest value
+     */
+    bool full () const {
+        return ring_size == capacity();
+    }
+
+    // -----------
+    // first_half
+    // -----------
+
+    /**
+     * @returns the contiguous run from the oldest value up to the end of the row
+     *          or the newest value, whichever comes first
+     */
+    row_span<T> first_half () {
+        row_span<T> x = {ring + oldest, std::min(ring_size, capacity() - oldest)};
+        return x;
+    }
+
+    row_span<const T> first_half () const {
+        row_span<const T> x = {ring + oldest, std::min(ring_size, capacity() - oldest)};
+        return x;
+    }
+
+    // -----------
+    // second_half
+    // -----------
+
+    /**
+     * @returns the contiguous run that wrapped around to the start of the row, possibly empty
+     */
+    row_span<T> second_half () {
+        row_span<T> x = {ring, ring_size - first_half().length};
+        return x;
+    }
+
+    row_span<const T> second_half () const {
+        row_span<const T> x = {ring, ring_size - first_half().length};
+        return x;
+    }
+
+    // ---
+    // pop
+    // ---
+
+    /**
+     * drop the oldest value, its slot is reused later
+     */
+    void pop_front () {
+        assert(!empty());
+        oldest = wrap(oldest + 1);
+        --ring_size;
+        assert(valid());
+    }
+
+    /**
+     * drop the newest value, its slot is reused later
+     */
+    void pop_back () {
+        assert(!empty());
+        --ring_size;
+        assert(valid());
+    }
+
+    // ----
+    // push
+    // ----
+
+    /**
+     * add the newest value, overwriting the oldest one when the window is full. O(1),
+     * no allocation and no branch other than the wrap
+     * @param val the value to add
+     */
+    void push_back (const_reference val) {
+        ring[wrap(oldest + ring_size)] = val;
+        size_t f = full();
+        oldest = wrap(oldest + f);
+        ring_size += 1 - f;
+        assert(valid());
+    }
+
+    // ----
+    // size
+    // ----
+
+    /**
+     * @returns the number of values in the window
+     */
+    size_type size () const {
+        return ring_size;
+    }
+};
+
+#endif // RingDeque_h
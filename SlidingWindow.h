@@ -0,0 +1,290 @@
+// ------------------------------
+// projects/deque/SlidingWindow.h
+// Copyright (C) 2014
+// Taylor Gregston
+// ------------------------------
+
+#ifndef SlidingWindow_h
+#define SlidingWindow_h
+
+// --------
+// includes
+// --------
+
+#include <cassert>   // assert
+#include <cstddef>   // size_t
+
+#include "Deque.h"
+
+// --------------
+// sliding_window
+// --------------
+
+/**
+ * Rolling min, max and sum over a window of timestamped values, amortized O(1) per tick.
+ * The window is a my_deque of (timestamp, value) entries. The min and the max are each kept
+ * in a monotonic my_deque of (sequence, value) candidates: a value is dropped from the back
+ * as soon as a newer value beats it, so the front is always the answer. The sum is kept by
+ * adding on push and subtracting on evict, so T has to be invertible under +.
+ * Timestamps are expected to be non-decreasing.
+ */
+template < typename T, typename S = long long >
+class sliding_window {
+public:
+    // --------
+    // typedefs
+    // --------
+
+    typedef T      value_type;
+    typedef S      stamp_type;
+    typedef size_t size_type;
+
+private:
+    // -------
+    // entries
+    // -------
+
+    struct stamped {
+        stamp_type stamp;
+        value_type value;
+    };
+
+    struct candidate {
+        size_t     seq;   //position of the value in the stream
+        value_type value;
+    };
+
+    // ----
+    // data
+    // ----
+
+    my_deque<stamped>   window;   //every value in the window, oldest first
+    my_deque<candidate> lows;     //increasing values, front is the min
+    my_deque<candidate> highs;    //decreasing values, front is the max
+    value_type total;             //sum of the window
+    size_t next_seq;              //sequence of the next value pushed
+    size_t popped;                //pops from window since it was last compacted
+
+private:
+    // -----
+    // valid
+    // -----
+
+    bool valid () const {
+        return (lows.empty() == window.empty()) && (highs.empty() == window.empty()) &&
+               (window.size() <= next_seq);
+    }
+
+    /**
+     * my_deque keeps the rows in front of begin after pop_front, so rebuild d from
+     * its live rows once as many values have been popped as it holds
+     */
+    template <typename D>
+    static void compact (D& d) {
+        D x(d);
+        d.swap(x);
+    }
+
+    /**
+     * add one value to the monotonic deques
+     */
+    void admit (size_t seq, const value_type& v) {
+        while(!lows.empty() && !(lows.back().value < v))
+            lows.pop_back();
+        while(!highs.empty() && !(v < highs.back().value))
+            highs.pop_back();
+        candidate c = {seq, v};
+        lows.push_back(c);
+        highs.push_back(c);
+    }
+
+    /**
+     * drop the oldest value from the window and from the monotonic deques
+     */
+    void evict () {
+        size_t seq = next_seq - window.size();
+        total -= window.front().value;
+        window.pop_front();
+        if(lows.front().seq == seq)
+            lows.pop_front();
+        if(highs.front().seq == seq)
+            highs.pop_front();
+        if(++popped > window.size() + INITIAL_ROW_SIZE) {
+            compact(window);
+            compact(lows);
+            compact(highs);
+            popped = 0;
+        }
+    }
+
+public:
+    // ------------
+    // constructors
+    // ------------
+
+    /**
+     * create an empty window
+     */
+    sliding_window () :
+    window(), lows(), highs(), total(), next_seq(0), popped(0)
+    {}
+
+    // -----
+    // clear
+    // -----
+
+    /**
+     * empty the window
+     */
+    void clear () {
+        window.clear();
+        lows.clear();
+        highs.clear();
+        total = value_type();
+        popped = 0;
+    }
+
+    // -----
+    // empty
+    // -----
+
+    /**
+     * @returns true if size == 0
+     */
+    bool empty () const {
+        return window.empty();
+    }
+
+    // -----------------
+    // evict_front_until
+    // -----------------
+
+    /**
+     * drop every value stamped before cutoff
+     * @param   cutoff the oldest timestamp to keep
+     * @return  the number of values dropped
+     */
+    size_type evict_front_until (const stamp_type& cutoff) {
+        size_type n = 0;
+        while(!window.empty() && window.front().stamp < cutoff) {
+            evict();
+            ++n;
+        }
+        assert(valid());
+        return n;
+    }
+
+    // -----------
+    // front_stamp
+    // -----------
+
+    /**
+     * @returns the timestamp of the oldest value
+     */
+    const stamp_type& front_stamp () const {
+        assert(!empty());
+        return window.front().stamp;
+    }
+
+    // ---
+    // max
+    // ---
+
+    /**
+     * @returns the largest value in the window, O(1)
+     */
+    const value_type& max () const {
+        assert(!empty());
+        return highs.front().value;
+    }
+
+    // ---
+    // min
+    // ---
+
+    /**
+     * @returns the smallest value in the window, O(1)
+     */
+    const value_type& min () const {
+        assert(!empty());
+        return lows.front().value;
+    }
+
+    // ---------
+    // pop_front
+    // ---------
+
+    /**
+     * drop the oldest value, for windows measured in values rather than time
+     */
+    void pop_front () {
+        assert(!empty());
+        evict();
+        assert(valid());
+    }
+
+    // ---------
+    // push_back
+    // ---------
+
+    /**
+     * add the newest value, amortized O(1)
+     * @param   stamp the timestamp of the value, no earlier than the last one
+     * @param   v the value
+     */
+    void push_back (const stamp_type& stamp, const value_type& v) {
+        assert(empty() || !(stamp < window.back().stamp));
+        stamped e = {stamp, v};
+        window.push_back(e);
+        admit(next_seq++, v);
+        total += v;
+        assert(valid());
+    }
+
+    // -----------
+    // push_back_n
+    // -----------
+
+    /**
+     * add n values at once, for streams that arrive in batches
+     * @param   n the number of values
+     * @param   stamps iterator over the n timestamps
+     * @param   values iterator over the n values
+     */
+    template <typename SI, typename VI>
+    void push_back_n (size_type n, SI stamps, VI values) {
+        value_type added = value_type();
+        for(size_type i = 0; i < n; ++i, ++stamps, ++values) {
+            stamped e = {*stamps, *values};
+            window.push_back(e);
+            admit(next_seq++, e.value);
+            added += e.value;
+        }
+        total += added;
+        assert(valid());
+    }
+
+    // ----
+    // size
+    // ----
+
+    /**
+     * @returns the number of values in the window
+     */
+    size_type size () const {
+        return window.size();
+    }
+
+    // ---
+    // sum
+    // ---
+
+    /**
+     * @returns the sum of the window, O(1)
+     */
+    const value_type& sum () const {
+        return total;
+    }
+};
+
+#endif // SlidingWindow_h
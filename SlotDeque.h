@@ -0,0 +1,552 @@
+// --------------------------
+// projects/deque/SlotDeque.h
+// Copyright (C) 2014
+// Taylor Gregston
+// --------------------------
+
+#ifndef SlotDeque_h
+#define SlotDeque_h
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // fill
+#include <cassert>   // assert
+#include <cstddef>   // size_t
+#include <iterator>  // forward_iterator_tag
+#include <memory>    // allocator
+#include <stdexcept> // out_of_range
+
+#include "Deque.h"   // my_deque, INITIAL_ROW_SIZE, DIV_ROW_SHIFT, MOD_ROW_MASK
+
+// -------
+// defines
+// -------
+
+#define SLOT_NONE ((size_t)-1) // end of the free list
+
+// -----------
+// slot_handle
+// -----------
+
+/**
+ * A reference to an element of a slot_deque that can tell when it has gone stale.
+ * The generation is bumped every time the slot is erased, so an old handle never
+ * reaches whatever is put in the slot afterwards.
+ */
+struct slot_handle {
+    size_t index;      //slot number, row = index >> DIV_ROW_SHIFT
+    size_t generation; //generation of the slot when the handle was made
+
+    /**
+     * checks to see if the lhs == rhs
+     * @param   lhs the left hand side in question
+     * @param   rhs the right hand side in question
+     * @return  true if both handles name the same slot and generation
+     */
+    friend bool operator == (const slot_handle& lhs, const slot_handle& rhs) {
+        return (lhs.index == rhs.index) && (lhs.generation == rhs.generation);
+    }
+
+    /**
+     * checks to see if the lhs != rhs
+     * @param   lhs the left hand side in question
+     * @param   rhs the right hand side in question
+     * @return  false if both handles name the same slot and generation
+     */
+    friend bool operator != (const slot_handle& lhs, const slot_handle& rhs) {
+        return !(lhs == rhs);
+    }
+};
+
+// ----------
+// slot_deque
+// ----------
+
+/**
+ * An object pool on top of my_deque style rows.
+ * Elements are constructed in rows of INITIAL_ROW_SIZE and never move, insert and erase
+ * are O(1) through a free list, and iteration walks a per-row occupancy bitmap so holes
+ * left by erase are skipped a whole row at a time.
+ */
+template < typename T, typename A = std::allocator<T> >
+class slot_deque {
+    static_assert(INITIAL_ROW_SIZE <= 64, "the occupancy bitmap holds one row");
+
+public:
+    // --------
+    // typedefs
+    // --------
+
+    typedef A                                        allocator_type;
+    typedef typename allocator_type::value_type      value_type;
+
+    typedef typename allocator_type::size_type       size_type;
+    typedef typename allocator_type::difference_type difference_type;
+
+    typedef typename allocator_type::pointer         pointer;
+    typedef typename allocator_type::const_pointer   const_pointer;
+
+    typedef typename allocator_type::reference       reference;
+    typedef typename allocator_type::const_reference const_reference;
+
+    typedef slot_handle                              handle;
+
+private:
+    // --------
+    // slot_row
+    // --------
+
+    struct slot_row {
+        T*                 data;                         //INITIAL_ROW_SIZE raw slots
+        unsigned long long occupied;                     //bit i is set when data[i] is alive
+        size_t             generation[INITIAL_ROW_SIZE]; //bumped on every erase
+        size_t             next_free[INITIAL_ROW_SIZE];  //free list link while the slot is empty
+    };
+
+    // ----
+    // data
+    // ----
+
+    allocator_type _a;      //the element allocator
+    my_deque<slot_row, typename A::template rebind<slot_row>::other> rows; //row bookkeeping, never moves
+    size_t free_head;       //most recently erased slot, SLOT_NONE if none
+    size_t high_water;      //slots ever handed out, the next fresh slot
+    size_t live_count;      //how many elements are alive
+
+private:
+    // -----
+    // valid
+    // -----
+
+    bool valid () const {
+        return (live_count <= high_water) && (high_water <= (rows.size() << DIV_ROW_SHIFT));
+    }
+
+    /**
+     * @param   i a slot number below rows.size() << DIV_ROW_SHIFT
+     * @return  the row bookkeeping for slot i
+     */
+    slot_row& row_of (size_t i) {
+        return rows[i >> DIV_ROW_SHIFT];
+    }
+
+    const slot_row& row_of (size_t i) const {
+        return rows[i >> DIV_ROW_SHIFT];
+    }
+
+    /**
+     * @param   i a slot number below high_water
+     * @return  a handle to slot i in its current generation
+     */
+    handle handle_at (size_t i) const {
+        handle h = {i, row_of(i).generation[i & MOD_ROW_MASK]};
+        return h;
+    }
+
+    /**
+     * find the first live slot at or after i
+     * @param   i the slot to start from
+     * @return  the slot number, or the end position if there is none
+     */
+    size_t next_occupied (size_t i) const {
+        size_t r = i >> DIV_ROW_SHIFT;
+        if(r >= rows.size())
+            return rows.size() << DIV_ROW_SHIFT;
+        unsigned long long bits = rows[r].occupied & (~0ULL << (i & MOD_ROW_MASK));
+        while(!bits) {
+            if(++r == rows.size())
+                return r << DIV_ROW_SHIFT;
+            bits = rows[r].occupied;
+        }
+        return (r << DIV_ROW_SHIFT) + __builtin_ctzll(bits);
+    }
+
+    /**
+     * claim a free slot, from the free list first and then from fresh rows
+     * @return  the slot number, not yet marked occupied
+     */
+    size_t take_slot () {
+        if(free_head != SLOT_NONE) {
+            size_t i = free_head;
+            free_head = row_of(i).next_free[i & MOD_ROW_MASK];
+            return i;
+        }
+        if(high_water == (rows.size() << DIV_ROW_SHIFT)) {
+            slot_row r;
+            r.data = _a.allocate(INITIAL_ROW_SIZE);
+            r.occupied = 0;
+            std::fill(r.generation, r.generation + INITIAL_ROW_SIZE, 0);
+            std::fill(r.next_free, r.next_free + INITIAL_ROW_SIZE, SLOT_NONE);
+            try {
+                rows.push_back(r);
+            }
+            catch (...) {
+                _a.deallocate(r.data, INITIAL_ROW_SIZE);
+                throw;}
+        }
+        return high_water++;
+    }
+
+    /**
+     * put slot i at the head of the free list
+     * @param   i the slot to release, already destroyed and unmarked
+     */
+    void give_slot (size_t i) {
+        row_of(i).next_free[i & MOD_ROW_MASK] = free_head;
+        free_head = i;
+    }
+
+    slot_deque (const slot_deque&);
+    slot_deque& operator = (const slot_deque&);
+
+public:
+    // --------
+    // iterator
+    // --------
+
+    template <typename P, typename R, typename O>
+    class basic_iterator {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef std::forward_iterator_tag            iterator_category;
+        typedef typename slot_deque::value_type      value_type;
+        typedef typename slot_deque::difference_type difference_type;
+        typedef P                                    pointer;
+        typedef R                                    reference;
+
+    public:
+        // -----------
+        // operator ==
+        // -----------
+
+        /**
+         * checks to see if the lhs == rhs
+         * @param   lhs the left hand side in question
+         * @param   rhs the right hand side in question
+         * @return  true if the lhs and rhs point to the same slot
+         */
+        friend bool operator == (const basic_iterator& lhs, const basic_iterator& rhs) {
+            return (lhs.owner == rhs.owner) && (lhs.index == rhs.index);
+        }
+
+        /**
+         * checks to see if the lhs != rhs
+         * @param   lhs the left hand side in question
+         * @param   rhs the right hand side in question
+         * @return  false if the lhs and rhs point to the same slot
+         */
+        friend bool operator != (const basic_iterator& lhs, const basic_iterator& rhs) {
+            return !(lhs == rhs);
+        }
+
+    private:
+        // ----
+        // data
+        // ----
+
+        O* owner;
+        size_t index;
+
+    public:
+        // -----------
+        // constructor
+        // -----------
+
+        /**
+         * creates an iterator at the first live slot at or after index_
+         * @param   owner_ a pointer to the underlying container
+         * @param   index_ the slot to start looking from
+         */
+        basic_iterator (O* owner_, size_t index_) :
+        owner(owner_), index(owner_->next_occupied(index_))
+        {}
+
+        // ----------
+        // operator *
+        // ----------
+
+        /**
+         * dereference this iterator
+         * @returns the value at which this iterator is pointing
+         */
+        reference operator * () const {
+            return owner->row_of(index).data[index & MOD_ROW_MASK];
+        }
+
+        // -----------
+        // operator ->
+        // -----------
+
+        /**
+         * dereference pointer this iterator
+         * @returns a pointer to the value
+         */
+        pointer operator -> () const {
+            return &**this;
+        }
+
+        // -----------
+        // operator ++
+        // -----------
+
+        /**
+         * increment (pre) this iterator to the next live slot, skipping holes
+         * @returns iterator with its NEW value
+         */
+        basic_iterator& operator ++ () {
+            index = owner->next_occupied(index + 1);
+            return *this;
+        }
+
+        /**
+         * increment (post) this iterator to the next live slot, skipping holes
+         * @returns iterator with its OLD value
+         */
+        basic_iterator operator ++ (int) {
+            basic_iterator x = *this;
+            ++(*this);
+            return x;
+        }
+
+        // ---------
+        // to_handle
+        // ---------
+
+        /**
+         * @returns a handle to the element this iterator points to
+         */
+        handle to_handle () const {
+            return owner->handle_at(index);
+        }
+    };
+
+    typedef basic_iterator<pointer, reference, slot_deque>                   iterator;
+    typedef basic_iterator<const_pointer, const_reference, const slot_deque> const_iterator;
+
+public:
+    // ------------
+    // constructors
+    // ------------
+
+    /**
+     * create a new, empty slot_deque
+     * @param   a the allocator to be used for this pool
+     */
+    explicit slot_deque (const allocator_type& a = allocator_type()) :
+    _a(a), rows(a), free_head(SLOT_NONE), high_water(0), live_count(0)
+    {
+        assert(valid());
+    }
+
+    // ----------
+    // destructor
+    // ----------
+
+    /**
+     * destroy all live elements and free all rows
+     */
+    ~slot_deque () {
+        clear();
+        for(size_t r = 0; r < rows.size(); ++r)
+            _a.deallocate(rows[r].data, INITIAL_ROW_SIZE);
+    }
+
+    // ------
+    // insert
+    // ------
+
+    /**
+     * construct a copy of val in a free slot, O(1)
+     * @param   val the value to add
+     * @return  a handle to the new element, its address never changes while it is alive
+     */
+    handle insert (const_reference val) {
+        size_t i = take_slot();
+        slot_row& r = row_of(i);
+        try {
+            _a.construct(&r.data[i & MOD_ROW_MASK], val);
+        }
+        catch (...) {
+            give_slot(i);
+            throw;}
+        r.occupied |= 1ULL << (i & MOD_ROW_MASK);
+        ++live_count;
+        assert(valid());
+        return handle_at(i);
+    }
+
+    // -----
+    // erase
+    // -----
+
+    /**
+     * destroy the element h refers to and recycle its slot, O(1)
+     * @param   h the handle to the element
+     * @return  false if h was already stale, true otherwise
+     */
+    bool erase (handle h) {
+        if(!contains(h))
+            return false;
+        slot_row& r = row_of(h.index);
+        _a.destroy(&r.data[h.index & MOD_ROW_MASK]);
+        r.occupied &= ~(1ULL << (h.index & MOD_ROW_MASK));
+        ++r.generation[h.index & MOD_ROW_MASK];
+        give_slot(h.index);
+        --live_count;
+        assert(valid());
+        return true;
+    }
+
+    // --------
+    // contains
+    // --------
+
+    /**
+     * @param   h a handle from this pool
+     * @return  true if the element h refers to is still alive
+     */
+    bool contains (handle h) const {
+        if(h.index >= high_water)
+            return false;
+        const slot_row& r = row_of(h.index);
+        return ((r.occupied >> (h.index & MOD_ROW_MASK)) & 1) && (r.generation[h.index & MOD_ROW_MASK] == h.generation);
+    }
+
+    // ---
+    // get
+    // ---
+
+    /**
+     * look up a handle
+     * @param   h a handle from this pool
+     * @return  a pointer to the element, NULL if h is stale
+     */
+    pointer get (handle h) {
+        return contains(h) ? &row_of(h.index).data[h.index & MOD_ROW_MASK] : NULL;
+    }
+
+    const_pointer get (handle h) const {
+        return const_cast<slot_deque*>(this)->get(h);
+    }
+
+    // -----------
+    // operator []
+    // -----------
+
+    /**
+     * look up a handle that is known to be live
+     * @param   h a live handle from this pool
+     * @return  a reference to the element
+     */
+    reference operator [] (handle h) {
+        assert(contains(h));
+        return row_of(h.index).data[h.index & MOD_ROW_MASK];
+    }
+
+    const_reference operator [] (handle h) const {
+        return const_cast<slot_deque*>(this)->operator[](h);
+    }
+
+    // --
+    // at
+    // --
+
+    /**
+     * look up a handle
+     * @param   h a handle from this pool
+     * @return  a reference to the element
+     * @throws  out_of_range if h is stale
+     */
+    reference at (handle h) {
+        if(!contains(h))
+            throw std::out_of_range("at handle is stale");
+        return row_of(h.index).data[h.index & MOD_ROW_MASK];
+    }
+
+    const_reference at (handle h) const {
+        return const_cast<slot_deque*>(this)->at(h);
+    }
+
+    // -----
+    // begin
+    // -----
+
+    /**
+     * @returns an iterator pointing to the first live element
+     */
+    iterator begin () {
+        return iterator(this, 0);
+    }
+
+    const_iterator begin () const {
+        return const_iterator(this, 0);
+    }
+
+    // ---
+    // end
+    // ---
+
+    /**
+     * @returns an iterator pointing past the last slot
+     */
+    iterator end () {
+        return iterator(this, rows.size() << DIV_ROW_SHIFT);
+    }
+
+    const_iterator end () const {
+        return const_iterator(this, rows.size() << DIV_ROW_SHIFT);
+    }
+
+    // --------
+    // capacity
+    // --------
+
+    /**
+     * @returns how many elements fit before another row is allocated
+     */
+    size_type capacity () const {
+        return rows.size() << DIV_ROW_SHIFT;
+    }
+
+    // -----
+    // clear
+    // -----
+
+    /**
+     * destroy every live element, invalidating all handles; rows are kept for reuse
+     */
+    void clear () {
+        for(size_t i = next_occupied(0); i < high_water; i = next_occupied(i + 1))
+            erase(handle_at(i));
+        assert(!live_count);
+    }
+
+    // -----
+    // empty
+    // -----
+
+    /**
+     * @returns true if no element is alive
+     */
+    bool empty () const {
+        return !live_count;
+    }
+
+    // ----
+    // size
+    // ----
+
+    /**
+     * @returns the number of live elements
+     */
+    size_type size () const {
+        return live_count;
+    }
+};
+
+#endif // SlotDeque_h
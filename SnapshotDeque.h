@@ -0,0 +1,608 @@
+// ------------------------------
+// projects/deque/SnapshotDeque.h
+// Copyright (C) 2014
+// Taylor Gregston
+// ------------------------------
+
+#ifndef SnapshotDeque_h
+#define SnapshotDeque_h
+
+// --------
+// includes
+// --------
+
+#include <atomic>    // atomic, memory_order
+#include <cassert>   // assert
+#include <cstddef>   // size_t
+#include <iterator>  // bidirectional_iterator_tag
+#include <memory>    // allocator
+#include <stdexcept> // length_error, out_of_range
+
+#include "Deque.h"   // INITIAL_ROW_SIZE, DIV_ROW_SHIFT, MOD_ROW_MASK, destroy
+
+// -------
+// defines
+// -------
+
+#define SNAPSHOT_MAX_READERS 64  // default number of reader slots
+#define SNAPSHOT_IDLE_EPOCH  0   // epoch stored in a reader slot that is not pinned
+
+// --------------
+// snapshot_deque
+// --------------
+
+/**
+ * A single-writer / multi-reader append-only deque.
+ * Elements live in rows of INITIAL_ROW_SIZE exactly like my_deque, so they never move.
+ * The only thing that changes under the readers is the array of row pointers (the map).
+ * The writer publishes a new map when it runs out of row slots and retires the old one;
+ * retired maps are freed only once every reader that could still see them has left its epoch.
+ * Readers pin an epoch through a snapshot and then index, size and iterate without locks or loops.
+ */
+template < typename T, typename A = std::allocator<T>, size_t R = SNAPSHOT_MAX_READERS >
+class snapshot_deque {
+public:
+    // --------
+    // typedefs
+    // --------
+
+    typedef A                                        allocator_type;
+    typedef typename allocator_type::value_type      value_type;
+
+    typedef typename allocator_type::size_type       size_type;
+    typedef typename allocator_type::difference_type difference_type;
+
+    typedef typename allocator_type::pointer         pointer;
+    typedef typename allocator_type::const_pointer   const_pointer;
+
+    typedef typename allocator_type::reference       reference;
+    typedef typename allocator_type::const_reference const_reference;
+
+private:
+    // -------
+    // row_map
+    // -------
+
+    struct row_map {
+        T**      rows;          //row pointers, a slot is written once and never changes
+        size_t   capacity;      //how many row pointers fit in rows
+        row_map* retired_next;  //next map waiting to be reclaimed
+        size_t   retired_epoch; //epoch that was current when this map was replaced
+    };
+
+    // -----------
+    // reader_slot
+    // -----------
+
+    struct reader_slot {
+        std::atomic<size_t> epoch;   //pinned epoch, SNAPSHOT_IDLE_EPOCH when not reading
+        std::atomic<bool>   claimed; //owned by a reader
+        char pad[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>) - sizeof(std::atomic<bool>)]; //keep readers off each other's lines
+    };
+
+    // ----
+    // data
+    // ----
+
+    allocator_type _a;  //the element allocator
+    typename A::template rebind<T*>::other _ap;      //the row pointer allocator
+    typename A::template rebind<row_map>::other _am; //the map allocator
+
+    std::atomic<row_map*> current_map;    //map readers should pick up
+    std::atomic<size_t>   published_size; //number of elements readers may see
+    std::atomic<size_t>   global_epoch;   //bumped each time a map is retired
+    row_map*              retired_head;   //maps waiting for readers to leave (writer only)
+    reader_slot           slots[R];       //one per registered reader
+
+private:
+    // -----
+    // valid
+    // -----
+
+    bool valid () const {
+        const row_map* m = current_map.load(std::memory_order_relaxed);
+        return m && (published_size.load(std::memory_order_relaxed) <= (m->capacity << DIV_ROW_SHIFT));
+    }
+
+    /**
+     * allocate a map with room for c row pointers, all set to 0
+     * @param   c the number of row pointers
+     * @return  the new map
+     */
+    row_map* make_map (size_t c) {
+        row_map* m = _am.allocate(1);
+        try {
+            m->rows = _ap.allocate(c);
+        }
+        catch (...) {
+            _am.deallocate(m, 1);
+            throw;}
+        uninitialized_fill(_ap, m->rows, m->rows + c, (T*)0);
+        m->capacity = c;
+        m->retired_next = NULL;
+        m->retired_epoch = 0;
+        return m;
+    }
+
+    /**
+     * free a map, but not the rows it points to
+     * @param   m the map to free
+     */
+    void free_map (row_map* m) {
+        destroy(_ap, m->rows, m->rows + m->capacity);
+        _ap.deallocate(m->rows, m->capacity);
+        _am.deallocate(m, 1);
+    }
+
+    /**
+     * publish a map twice the size of the current one and retire the old one
+     * @return  the new map
+     */
+    row_map* grow_map () {
+        row_map* old = current_map.load(std::memory_order_relaxed);
+        row_map* m = make_map(old->capacity << 1);
+        std::copy(old->rows, old->rows + old->capacity, m->rows);
+
+        //readers that load the map from here on see m
+        current_map.store(m, std::memory_order_seq_cst);
+
+        old->retired_epoch = global_epoch.fetch_add(1, std::memory_order_seq_cst);
+        old->retired_next = retired_head;
+        retired_head = old;
+
+        reclaim();
+        return m;
+    }
+
+public:
+    // --------------
+    // const_iterator
+    // --------------
+
+    class snapshot;
+
+    class const_iterator {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef std::bidirectional_iterator_tag          iterator_category;
+        typedef typename snapshot_deque::value_type      value_type;
+        typedef typename snapshot_deque::difference_type difference_type;
+        typedef typename snapshot_deque::const_pointer   pointer;
+        typedef typename snapshot_deque::const_reference reference;
+
+    public:
+        // -----------
+        // operator ==
+        // -----------
+
+        /**
+         * checks to see if the lhs == rhs
+         * @param   lhs the left hand side in question
+         * @param   rhs the right hand side in question
+         * @return  true if the lhs and rhs point to the same value
+         */
+        friend bool operator == (const const_iterator& lhs, const const_iterator& rhs) {
+            return (lhs.owner == rhs.owner) && (lhs.index == rhs.index);
+        }
+
+        /**
+         * checks to see if the lhs != rhs
+         * @param   lhs the left hand side in question
+         * @param   rhs the right hand side in question
+         * @return  false if the lhs and rhs point to the same value
+         */
+        friend bool operator != (const const_iterator& lhs, const const_iterator& rhs) {
+            return !(lhs == rhs);
+        }
+
+    private:
+        // ----
+        // data
+        // ----
+
+        const snapshot* owner;
+        size_t index;
+
+    private:
+        // -----
+        // valid
+        // -----
+
+        bool valid () const {
+            return (owner != NULL) && (index <= owner->size());
+        }
+
+    public:
+        // -----------
+        // constructor
+        // -----------
+
+        /**
+         * creates a new snapshot_deque<T>::const_iterator
+         * @param   owner_ the snapshot being iterated
+         * @param   index_ the index in the snapshot to point to
+         */
+        const_iterator (const snapshot* owner_, size_t index_) :
+        owner(owner_), index(index_)
+        {
+            assert(valid());
+        }
+
+        // ----------
+        // operator *
+        // ----------
+
+        /**
+         * dereference this iterator
+         * @returns the value at which this iterator is pointing
+         */
+        reference operator * () const {
+            return (*owner)[index];
+        }
+
+        // -----------
+        // operator ->
+        // -----------
+
+        /**
+         * dereference pointer this iterator
+         * @returns a pointer to this
+         */
+        pointer operator -> () const {
+            return &**this;
+        }
+
+        // -----------
+        // operator ++
+        // -----------
+
+        /**
+         * increment (pre) this iterator by one. the iterator will point to the next value
+         * @returns iterator with its NEW value
+         */
+        const_iterator& operator ++ () {
+            ++index;
+            assert(valid());
+            return *this;
+        }
+
+        /**
+         * increment (post) this iterator by one. the iterator will point to the next value
+         * @returns iterator with its OLD value
+         */
+        const_iterator operator ++ (int) {
+            const_iterator x = *this;
+            ++(*this);
+            return x;
+        }
+
+        // -----------
+        // operator --
+        // -----------
+
+        /**
+         * decrement (pre) this iterator by one. the iterator will point to the previous value
+         * @returns iterator with its NEW value
+         */
+        const_iterator& operator -- () {
+            --index;
+            assert(valid());
+            return *this;
+        }
+
+        /**
+         * decrement (post) this iterator by one. the iterator will point to the previous value
+         * @returns iterator with its OLD value
+         */
+        const_iterator operator -- (int) {
+            const_iterator x = *this;
+            --(*this);
+            return x;
+        }
+    };
+
+    // ------
+    // reader
+    // ------
+
+    /**
+     * A registration of one reading thread. Claiming a slot is the only step that may retry;
+     * everything done through a snapshot afterwards is wait-free.
+     */
+    class reader {
+        friend class snapshot;
+
+    private:
+        // ----
+        // data
+        // ----
+
+        const snapshot_deque* owner;
+        reader_slot* slot;
+
+        reader (const reader&);
+        reader& operator = (const reader&);
+
+    public:
+        // -----------
+        // constructor
+        // -----------
+
+        /**
+         * claim a reader slot in d
+         * @param   d the deque to be read
+         * @throws  length_error if all R slots are taken
+         */
+        explicit reader (const snapshot_deque& d) :
+        owner(&d), slot(NULL)
+        {
+            reader_slot* s = const_cast<reader_slot*>(d.slots);
+            for(size_t i = 0; i < R; ++i) {
+                bool expected = false;
+                if(s[i].claimed.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+                    slot = &s[i];
+                    return;
+                }
+            }
+            throw std::length_error("snapshot_deque has no free reader slot");
+        }
+
+        // ----------
+        // destructor
+        // ----------
+
+        /**
+         * give the slot back
+         */
+        ~reader () {
+            assert(slot->epoch.load(std::memory_order_relaxed) == SNAPSHOT_IDLE_EPOCH);
+            slot->claimed.store(false, std::memory_order_release);
+        }
+    };
+
+    // --------
+    // snapshot
+    // --------
+
+    /**
+     * A consistent prefix of the deque as of construction.
+     * While a snapshot is alive the map it captured cannot be freed, so indexing
+     * costs two plain loads and never waits on the writer.
+     */
+    class snapshot {
+    private:
+        // ----
+        // data
+        // ----
+
+        reader_slot*   slot;
+        const row_map* map;
+        size_t         count;
+
+        snapshot (const snapshot&);
+        snapshot& operator = (const snapshot&);
+
+    public:
+        // -----------
+        // constructor
+        // -----------
+
+        /**
+         * pin the current epoch and capture the published prefix
+         * @param   r the reader taking the snapshot, at most one live snapshot per reader
+         */
+        explicit snapshot (const reader& r) :
+        slot(r.slot)
+        {
+            assert(slot->epoch.load(std::memory_order_relaxed) == SNAPSHOT_IDLE_EPOCH);
+            slot->epoch.store(r.owner->global_epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+            count = r.owner->published_size.load(std::memory_order_acquire);
+            map = r.owner->current_map.load(std::memory_order_seq_cst);
+        }
+
+        // ----------
+        // destructor
+        // ----------
+
+        /**
+         * unpin, letting the writer reclaim anything retired in the meantime
+         */
+        ~snapshot () {
+            slot->epoch.store(SNAPSHOT_IDLE_EPOCH, std::memory_order_release);
+        }
+
+        /**
+         * index this snapshot
+         * @param index the index in this snapshot to be evaluated
+         * @return a reference to the value at index
+         */
+        const_reference operator [] (size_type index) const {
+            return map->rows[index >> DIV_ROW_SHIFT][index & MOD_ROW_MASK];
+        }
+
+        /**
+         * index this snapshot
+         * @param index the index in this snapshot to be evaluated
+         * @return a reference to the value at index
+         * @throws out_of_range if the index is greater or equal to size
+         */
+        const_reference at (size_type index) const {
+            if(index >= count)
+                throw std::out_of_range("at index out of range");
+            return (*this)[index];
+        }
+
+        /**
+         * @returns the number of elements captured by this snapshot
+         */
+        size_type size () const {
+            return count;
+        }
+
+        /**
+         * @returns true if this snapshot captured no elements
+         */
+        bool empty () const {
+            return !count;
+        }
+
+        /**
+         * @returns an iterator pointing to the first value
+         */
+        const_iterator begin () const {
+            return const_iterator(this, 0);
+        }
+
+        /**
+         * @returns an iterator pointing past the last captured value
+         */
+        const_iterator end () const {
+            return const_iterator(this, count);
+        }
+    };
+
+public:
+    // ------------
+    // constructors
+    // ------------
+
+    /**
+     * create a new, empty snapshot_deque
+     * @param   a the allocator to be used for this deque
+     */
+    explicit snapshot_deque (const allocator_type& a = allocator_type()) :
+    _a(a), _ap(a), _am(a),
+    current_map(NULL), published_size(0), global_epoch(SNAPSHOT_IDLE_EPOCH + 1), retired_head(NULL)
+    {
+        for(size_t i = 0; i < R; ++i) {
+            slots[i].epoch.store(SNAPSHOT_IDLE_EPOCH, std::memory_order_relaxed);
+            slots[i].claimed.store(false, std::memory_order_relaxed);
+        }
+        current_map.store(make_map(1), std::memory_order_release);
+        assert(valid());
+    }
+
+    // ----------
+    // destructor
+    // ----------
+
+    /**
+     * destroy all elements and free all memory, no reader may be registered
+     */
+    ~snapshot_deque () {
+        row_map* m = current_map.load(std::memory_order_relaxed);
+        size_t s = published_size.load(std::memory_order_relaxed);
+        for(size_t i = 0; i < s; ++i)
+            _a.destroy(&m->rows[i >> DIV_ROW_SHIFT][i & MOD_ROW_MASK]);
+        for(size_t i = 0; i < m->capacity; ++i)
+            if(m->rows[i])
+                _a.deallocate(m->rows[i], INITIAL_ROW_SIZE);
+        free_map(m);
+
+        while(retired_head) {
+            row_map* next = retired_head->retired_next;
+            free_map(retired_head);
+            retired_head = next;
+        }
+    }
+
+private:
+    snapshot_deque (const snapshot_deque&);
+    snapshot_deque& operator = (const snapshot_deque&);
+
+public:
+    // ----
+    // back
+    // ----
+
+    /**
+     * reference the back end of this deque (writer only)
+     * @returns the reference to the last element pushed
+     */
+    const_reference back () const {
+        size_t i = published_size.load(std::memory_order_relaxed) - 1;
+        return current_map.load(std::memory_order_relaxed)->rows[i >> DIV_ROW_SHIFT][i & MOD_ROW_MASK];
+    }
+
+    // -----
+    // empty
+    // -----
+
+    /**
+     * checks to see if the deque contains any values, wait-free
+     * @returns true if size == 0
+     */
+    bool empty () const {
+        return !size();
+    }
+
+    // ---------
+    // push_back
+    // ---------
+
+    /**
+     * append a value and publish it to readers (writer only)
+     * @param val the value to add to the deque
+     */
+    void push_back (const_reference val) {
+        size_t s = published_size.load(std::memory_order_relaxed);
+        row_map* m = current_map.load(std::memory_order_relaxed);
+        T*& row = ((s >> DIV_ROW_SHIFT) == m->capacity ? grow_map() : m)->rows[s >> DIV_ROW_SHIFT];
+        if(!row)
+            row = _a.allocate(INITIAL_ROW_SIZE);
+        _a.construct(&row[s & MOD_ROW_MASK], val);
+
+        //the element and any new map are visible before the size that covers them
+        published_size.store(s + 1, std::memory_order_release);
+        assert(valid());
+    }
+
+    // -------
+    // reclaim
+    // -------
+
+    /**
+     * free every retired map that no pinned reader can still be looking at (writer only)
+     * @returns the number of maps still waiting
+     */
+    size_type reclaim () {
+        size_t oldest = static_cast<size_t>(-1);
+        for(size_t i = 0; i < R; ++i) {
+            size_t e = slots[i].epoch.load(std::memory_order_seq_cst);
+            if(e != SNAPSHOT_IDLE_EPOCH && e < oldest)
+                oldest = e;
+        }
+
+        size_type waiting = 0;
+        row_map** link = &retired_head;
+        while(*link) {
+            row_map* m = *link;
+            if(m->retired_epoch < oldest) {
+                *link = m->retired_next;
+                free_map(m);
+            }
+            else {
+                link = &m->retired_next;
+                ++waiting;
+            }
+        }
+        return waiting;
+    }
+
+    // ----
+    // size
+    // ----
+
+    /**
+     * get the number of published elements, wait-free
+     * @returns the number of elements in this deque
+     */
+    size_type size () const {
+        return published_size.load(std::memory_order_acquire);
+    }
+};
+
+#endif // SnapshotDeque_h
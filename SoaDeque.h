@@ -0,0 +1,577 @@
+// -------------------------
+// projects/deque/SoaDeque.h
+// Copyright (C) 2014
+// Taylor Gregston
+// -------------------------
+
+#ifndef SoaDeque_h
+#define SoaDeque_h
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // copy, copy_backward, fill, max, min, swap
+#include <cassert>   // assert
+#include <cstddef>   // size_t, ptrdiff_t
+#include <memory>    // allocator
+#include <new>       // placement new
+#include <stdexcept> // out_of_range
+#include <tuple>     // tuple, get, tie, tuple_element
+#include <type_traits> // remove_pointer
+
+#include "Deque.h"
+
+// -------
+// defines
+// -------
+
+/**
+ * Rows of a soa_deque hold SOA_ROW_SIZE records, one column per field.
+ * Rows are wider than INITIAL_ROW_SIZE so that a column scan runs long
+ * enough inside a row to be worth vectorizing.
+ */
+
+#define SOA_ROW_SHIFT       8   // THIS VALUE MUST BE == log2(SOA_ROW_SIZE)
+#define SOA_ROW_SIZE        256 // THIS VALUE MUST BE == 2^SOA_ROW_SHIFT
+#define SOA_ROW_MASK        255 // THIS VALUE MUST BE == SOA_ROW_SIZE - 1
+
+// -----------
+// soa_indices
+// -----------
+
+template <size_t... Is>
+struct soa_indices {};
+
+template <size_t N, size_t... Is>
+struct soa_make_indices : soa_make_indices<N - 1, N - 1, Is...> {};
+
+template <size_t... Is>
+struct soa_make_indices<0, Is...> {
+    typedef soa_indices<Is...> type;
+};
+
+// --------
+// soa_each
+// --------
+
+/**
+ * Walks the columns of one row from field K to field N - 1.
+ */
+template <size_t K, size_t N>
+struct soa_each {
+    /**
+     * allocate columns K through N - 1 of row r
+     */
+    template <typename Row>
+    static void allocate (Row& r) {
+        typedef typename std::remove_pointer<typename std::tuple_element<K, Row>::type>::type E;
+        std::get<K>(r) = std::allocator<E>().allocate(SOA_ROW_SIZE);
+        try {
+            soa_each<K + 1, N>::allocate(r);
+        }
+        catch (...) {
+            std::allocator<E>().deallocate(std::get<K>(r), SOA_ROW_SIZE);
+            throw;}
+    }
+
+    /**
+     * free columns K through N - 1 of row r
+     */
+    template <typename Row>
+    static void deallocate (Row& r) {
+        typedef typename std::remove_pointer<typename std::tuple_element<K, Row>::type>::type E;
+        std::allocator<E>().deallocate(std::get<K>(r), SOA_ROW_SIZE);
+        std::get<K>(r) = NULL;
+        soa_each<K + 1, N>::deallocate(r);
+    }
+
+    /**
+     * construct fields K through N - 1 of record i of row r from the fields of v
+     */
+    template <typename Row, typename V>
+    static void construct (Row& r, size_t i, const V& v) {
+        typedef typename std::remove_pointer<typename std::tuple_element<K, Row>::type>::type E;
+        ::new (static_cast<void*>(&std::get<K>(r)[i])) E(std::get<K>(v));
+        try {
+            soa_each<K + 1, N>::construct(r, i, v);
+        }
+        catch (...) {
+            std::get<K>(r)[i].~E();
+            throw;}
+    }
+
+    /**
+     * destroy fields K through N - 1 of record i of row r
+     */
+    template <typename Row>
+    static void destroy (Row& r, size_t i) {
+        typedef typename std::remove_pointer<typename std::tuple_element<K, Row>::type>::type E;
+        std::get<K>(r)[i].~E();
+        soa_each<K + 1, N>::destroy(r, i);
+    }
+};
+
+template <size_t N>
+struct soa_each<N, N> {
+    template <typename Row>
+    static void allocate (Row&) {}
+
+    template <typename Row>
+    static void deallocate (Row&) {}
+
+    template <typename Row, typename V>
+    static void construct (Row&, size_t, const V&) {}
+
+    template <typename Row>
+    static void destroy (Row&, size_t) {}
+};
+
+// ---------
+// soa_deque
+// ---------
+
+/**
+ * A deque of records stored field by field.
+ * The map and the begin_index/end_index bookkeeping are the same as my_deque, but each row
+ * holds one array per field, so a scan of one field only touches that field's memory.
+ * Records are pushed and popped whole; fields are read through get<K>, segment<K> and for_each<K>.
+ */
+template <typename... Ts>
+class soa_deque {
+public:
+    // --------
+    // typedefs
+    // --------
+
+    typedef std::tuple<Ts...> value_type;
+    typedef size_t            size_type;
+    typedef ptrdiff_t         difference_type;
+
+    static const size_t field_count = sizeof...(Ts);
+
+    template <size_t K>
+    struct column {
+        typedef typename std::tuple_element<K, value_type>::type type;
+    };
+
+private:
+    typedef std::tuple<Ts*...>                                  row_type;
+    typedef soa_each<0, sizeof...(Ts)>                          each;
+    typedef typename soa_make_indices<sizeof...(Ts)>::type      indices;
+
+    // ----
+    // data
+    // ----
+
+    row_type* deque_root; //root of our 2d deque, rows are all 0 outside the live range
+    size_t row_count;     //number of row slots in the map
+    size_t begin_index;   //where is the begining?
+    size_t end_index;     //where is the end?
+
+private:
+    // -----
+    // valid
+    // -----
+
+    bool valid () const {
+        return (begin_index <= end_index) && (end_index <= (row_count << SOA_ROW_SHIFT));
+    }
+
+    /**
+     * @param   i an absolute record index
+     * @return  the row holding record i
+     */
+    row_type& row_of (size_t i) const {
+        return deque_root[i >> SOA_ROW_SHIFT];
+    }
+
+    /**
+     * make sure the row holding record i exists
+     * @param   i an absolute record index inside the map
+     */
+    void touch_row (size_t i) {
+        row_type& r = row_of(i);
+        if(!std::get<0>(r))
+            each::allocate(r);
+    }
+
+    template <size_t... Is>
+    value_type record (size_t i, soa_indices<Is...>) const {
+        return value_type(std::get<Is>(row_of(i))[i & SOA_ROW_MASK]...);
+    }
+
+    /**
+     * allocate a map of r empty row slots
+     * @param   r the number of row slots
+     */
+    void allocate_map (size_t r) {
+        row_count = r;
+        deque_root = std::allocator<row_type>().allocate(row_count);
+        std::uninitialized_fill(deque_root, deque_root + row_count, row_type());
+    }
+
+    /**
+     * destroy every record and free every row and the map
+     */
+    void release () {
+        for(size_t i = begin_index; i < end_index; ++i)
+            each::destroy(row_of(i), i & SOA_ROW_MASK);
+        for(size_t i = 0; i < row_count; ++i)
+            if(std::get<0>(deque_root[i]))
+                each::deallocate(deque_root[i]);
+        std::allocator<row_type>().deallocate(deque_root, row_count);
+    }
+
+    /**
+     * make room for add more rows at one end of the map. when the live rows take up
+     * less than half of the map they are slid to the middle, otherwise the map doubles
+     * @param   add the number of row slots needed past the live rows
+     * @param   at_front true to make the room in front of begin, false after end
+     */
+    void reserve_rows (size_t add, bool at_front) {
+        size_t first = begin_index >> SOA_ROW_SHIFT;
+        size_t last = std::max(first + 1, (end_index + SOA_ROW_SIZE - 1) >> SOA_ROW_SHIFT);
+        size_t live = last - first;
+        size_t need = live + add;
+
+        for(size_t i = 0; i < row_count; ++i)
+            if((i < first || i >= last) && std::get<0>(deque_root[i]))
+                each::deallocate(deque_root[i]);
+
+        size_t new_count = row_count;
+        if(2 * need > row_count)
+            new_count = std::max(2 * row_count, 2 * need);
+        size_t new_first = (new_count - need) / 2 + (at_front ? add : 0);
+
+        if(new_count == row_count && new_first > first) {
+            std::copy_backward(deque_root + first, deque_root + last, deque_root + new_first + live);
+            std::fill(deque_root + first, deque_root + std::min(new_first, last), row_type());
+        }
+        else if(new_count == row_count && new_first < first) {
+            std::copy(deque_root + first, deque_root + last, deque_root + new_first);
+            std::fill(deque_root + std::max(new_first + live, first), deque_root + last, row_type());
+        }
+        else if(new_count != row_count) {
+            row_type* new_root = std::allocator<row_type>().allocate(new_count);
+            std::uninitialized_fill(new_root, new_root + new_count, row_type());
+            std::copy(deque_root + first, deque_root + last, new_root + new_first);
+            std::allocator<row_type>().deallocate(deque_root, row_count);
+            deque_root = new_root;
+            row_count = new_count;
+        }
+
+        size_t shift = (new_first << SOA_ROW_SHIFT) - (first << SOA_ROW_SHIFT);
+        begin_index += shift;
+        end_index += shift;
+        assert(valid());
+    }
+
+    /**
+     * construct a record at the back from anything std::get can take apart
+     */
+    template <typename V>
+    void push_back_tuple (const V& v) {
+        if(end_index == (row_count << SOA_ROW_SHIFT))
+            reserve_rows(1, false);
+        touch_row(end_index);
+        each::construct(row_of(end_index), end_index & SOA_ROW_MASK, v);
+        ++end_index;
+        assert(valid());
+    }
+
+    /**
+     * construct a record at the front from anything std::get can take apart
+     */
+    template <typename V>
+    void push_front_tuple (const V& v) {
+        if(begin_index == 0)
+            reserve_rows(1, true);
+        touch_row(begin_index - 1);
+        each::construct(row_of(begin_index - 1), (begin_index - 1) & SOA_ROW_MASK, v);
+        --begin_index;
+        assert(valid());
+    }
+
+public:
+    // ------------
+    // constructors
+    // ------------
+
+    /**
+     * create a new, empty soa_deque
+     */
+    soa_deque () {
+        allocate_map(1);
+        begin_index = SOA_ROW_SIZE >> 1; //start at the middle
+        end_index = begin_index;
+        assert(valid());
+    }
+
+    /**
+     * create a new soa_deque holding the same records as that
+     * @param   that the deque to be replicated
+     */
+    soa_deque (const soa_deque& that) {
+        allocate_map(1);
+        begin_index = 0;
+        end_index = 0;
+        try {
+            for(size_type i = 0; i < that.size(); ++i)
+                push_back(that[i]);
+        }
+        catch (...) {
+            release();
+            throw;}
+    }
+
+    // ----------
+    // destructor
+    // ----------
+
+    /**
+     * destroy every record and free all memory
+     */
+    ~soa_deque () {
+        release();
+    }
+
+    // ----------
+    // operator =
+    // ----------
+
+    /**
+     * assignment operator, will set this to have records equivalent to rhs
+     * @param rhs the deque that is to be replicated into this
+     * @returns this
+     */
+    soa_deque& operator = (const soa_deque& rhs) {
+        if(this != &rhs) {
+            soa_deque x(rhs);
+            swap(x);
+        }
+        return *this;
+    }
+
+    // -----------
+    // operator []
+    // -----------
+
+    /**
+     * gather one record
+     * @param index the index in this deque to be evaluated
+     * @return a copy of the record at index
+     */
+    value_type operator [] (size_type index) const {
+        return record(begin_index + index, indices());
+    }
+
+    // --
+    // at
+    // --
+
+    /**
+     * gather one record
+     * @param index the index in this deque to be evaluated
+     * @return a copy of the record at index
+     * @throws out_of_range if the index is greater or equal to size
+     */
+    value_type at (size_type index) const {
+        if(index >= size())
+            throw std::out_of_range("at index out of range");
+        return (*this)[index];
+    }
+
+    // ---
+    // get
+    // ---
+
+    /**
+     * reference one field of one record
+     * @param index the index of the record
+     * @return a reference to field K of the record
+     */
+    template <size_t K>
+    typename column<K>::type& get (size_type index) {
+        size_t i = begin_index + index;
+        return std::get<K>(row_of(i))[i & SOA_ROW_MASK];
+    }
+
+    template <size_t K>
+    const typename column<K>::type& get (size_type index) const {
+        return const_cast<soa_deque*>(this)->template get<K>(index);
+    }
+
+    // -------------
+    // segment_count
+    // -------------
+
+    /**
+     * @returns how many contiguous runs a column is split into, one per row touched
+     */
+    size_type segment_count () const {
+        if(begin_index == end_index)
+            return 0;
+        return ((end_index - 1) >> SOA_ROW_SHIFT) - (begin_index >> SOA_ROW_SHIFT) + 1;
+    }
+
+    // -------
+    // segment
+    // -------
+
+    /**
+     * get one contiguous run of column K
+     * @param s the run, 0 <= s < segment_count()
+     * @return the run's address and length
+     */
+    template <size_t K>
+    row_span<typename column<K>::type> segment (size_type s) {
+        size_t r = (begin_index >> SOA_ROW_SHIFT) + s;
+        size_t lo = std::max(begin_index, r << SOA_ROW_SHIFT);
+        size_t hi = std::min(end_index, (r + 1) << SOA_ROW_SHIFT);
+        row_span<typename column<K>::type> x = {&std::get<K>(deque_root[r])[lo & SOA_ROW_MASK], hi - lo};
+        return x;
+    }
+
+    template <size_t K>
+    row_span<const typename column<K>::type> segment (size_type s) const {
+        row_span<typename column<K>::type> x = const_cast<soa_deque*>(this)->template segment<K>(s);
+        row_span<const typename column<K>::type> y = {x.data, x.length};
+        return y;
+    }
+
+    // --------
+    // for_each
+    // --------
+
+    /**
+     * apply f to every value of column K, front to back. the inner loop runs
+     * over one contiguous row at a time so the compiler can vectorize it
+     * @param f the function to apply
+     * @return f
+     */
+    template <size_t K, typename F>
+    F for_each (F f) const {
+        const size_type n = segment_count();
+        for(size_type s = 0; s < n; ++s) {
+            row_span<const typename column<K>::type> x = segment<K>(s);
+            const typename column<K>::type* p = x.data;
+            for(size_t i = 0; i < x.length; ++i)
+                f(p[i]);
+        }
+        return f;
+    }
+
+    // -----
+    // clear
+    // -----
+
+    /**
+     * destroy every record, keeping the map
+     */
+    void clear () {
+        while(!empty())
+            pop_back();
+    }
+
+    // -----
+    // empty
+    // -----
+
+    /**
+     * @returns true if size == 0
+     */
+    bool empty () const {
+        return !size();
+    }
+
+    // ---
+    // pop
+    // ---
+
+    /**
+     * removes (destroys) the record at the back of the deque
+     */
+    void pop_back () {
+        assert(!empty());
+        --end_index;
+        each::destroy(row_of(end_index), end_index & SOA_ROW_MASK);
+        assert(valid());
+    }
+
+    /**
+     * removes (destroys) the record at the front of the deque, freeing the row it leaves
+     */
+    void pop_front () {
+        assert(!empty());
+        each::destroy(row_of(begin_index), begin_index & SOA_ROW_MASK);
+        ++begin_index;
+        if(!(begin_index & SOA_ROW_MASK))
+            each::deallocate(deque_root[(begin_index >> SOA_ROW_SHIFT) - 1]);
+        assert(valid());
+    }
+
+    // ----
+    // push
+    // ----
+
+    /**
+     * push a record onto the back side of this deque
+     * @param v the fields of the record
+     */
+    void push_back (const Ts&... v) {
+        push_back_tuple(std::tie(v...));
+    }
+
+    /**
+     * push a record onto the back side of this deque
+     * @param v the record
+     */
+    void push_back (const value_type& v) {
+        push_back_tuple(v);
+    }
+
+    /**
+     * push a record onto the front side of this deque
+     * @param v the fields of the record
+     */
+    void push_front (const Ts&... v) {
+        push_front_tuple(std::tie(v...));
+    }
+
+    /**
+     * push a record onto the front side of this deque
+     * @param v the record
+     */
+    void push_front (const value_type& v) {
+        push_front_tuple(v);
+    }
+
+    // ----
+    // size
+    // ----
+
+    /**
+     * @returns the number of records in this deque
+     */
+    size_type size () const {
+        return end_index - begin_index;
+    }
+
+    // ----
+    // swap
+    // ----
+
+    /**
+     * swap this deque's records with another
+     * @param other the other deque to be swapped with
+     */
+    void swap (soa_deque& other) {
+        std::swap(deque_root, other.deque_root);
+        std::swap(row_count, other.row_count);
+        std::swap(begin_index, other.begin_index);
+        std::swap(end_index, other.end_index);
+    }
+};
+
+#endif // SoaDeque_h
@@ -0,0 +1,300 @@
+// ----------------------------
+// projects/deque/SortedDeque.h
+// Copyright (C) 2014
+// Taylor Gregston
+// ----------------------------
+
+#ifndef SortedDeque_h
+#define SortedDeque_h
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // lower_bound, upper_bound
+#include <cassert>   // assert
+#include <cstddef>   // size_t
+#include <functional> // less
+#include <memory>    // allocator
+#include <stdexcept> // out_of_range
+#include <vector>    // vector
+
+#include "Deque.h"
+
+// ------------
+// sorted_deque
+// ------------
+
+/**
+ * A my_deque of non-decreasing values, pushed at the back and popped at the front, with
+ * lower_bound and upper_bound in O(log n) and few cache misses.
+ * Next to the values it keeps the fences, the first value of every row, in one contiguous
+ * array small enough to stay in cache. A search binary-searches the fences for the row
+ * and then searches that row alone, which is one contiguous run.
+ * The fences are kept up as push_back starts rows and pop_front finishes them.
+ */
+template < typename T, typename C = std::less<T>, typename A = std::allocator<T> >
+class sorted_deque {
+public:
+    // --------
+    // typedefs
+    // --------
+
+    typedef my_deque<T, A>                  deque_type;
+    typedef C                               value_compare;
+    typedef T                               value_type;
+    typedef size_t                          size_type;
+    typedef typename deque_type::const_iterator const_iterator;
+    typedef const T&                        const_reference;
+
+private:
+    // ----
+    // data
+    // ----
+
+    deque_type values;
+    std::vector<T> fences;  //first value of every row of values, from fences[head] on
+    size_t head;            //fences before head belong to popped rows
+    size_t popped;          //pops from values since it was last compacted
+    value_compare less;
+
+private:
+    // -----
+    // valid
+    // -----
+
+    bool valid () const {
+        return (fences.size() - head == values.segment_count()) && (head <= fences.size());
+    }
+
+    /**
+     * my_deque keeps the rows in front of begin after pop_front, so rebuild values from
+     * its live rows once as many values have been popped as it holds, and the fences with it
+     */
+    void compact () {
+        if(popped <= values.size() + INITIAL_ROW_SIZE)
+            return;
+        deque_type x(values);
+        values.swap(x);
+        fences.clear();
+        head = 0;
+        for(size_type s = 0; s < values.segment_count(); ++s)
+            fences.push_back(values.segment(s).data[0]);
+        popped = 0;
+    }
+
+    /**
+     * @param   s a segment of values
+     * @return  the index of its first value
+     */
+    size_type start (size_type s) const {
+        if(!s)
+            return 0;
+        return values.segment(0).length + (s - 1) * INITIAL_ROW_SIZE;
+    }
+
+    /**
+     * the search behind lower_bound and upper_bound
+     * @param   v the value to look for
+     * @param   bound std::lower_bound or std::upper_bound, used on the fences and then a row
+     * @return  the index found
+     */
+    template <typename F>
+    size_type search (const_reference v, F bound) const {
+        const T* first = fences.data() + head;
+        size_type n = fences.size() - head;
+        size_type j = bound(first, first + n, v, less) - first;
+        if(!j)
+            return 0;   //the first row is all past v, even if its fence is stale
+        row_span<const T> x = values.segment(j - 1);
+        size_type i = bound(x.begin(), x.end(), v, less) - x.begin();
+        if((i == x.length) && (j < n))
+            return start(j);
+        return start(j - 1) + i;
+    }
+
+public:
+    // ------------
+    // constructors
+    // ------------
+
+    /**
+     * create an empty sorted_deque
+     * @param   c the order the values are pushed in
+     * @param   a the allocator to be used for the values
+     */
+    explicit sorted_deque (const value_compare& c = value_compare(), const A& a = A()) :
+    values(a), head(0), popped(0), less(c)
+    {}
+
+    // -----------
+    // operator []
+    // -----------
+
+    /**
+     * @param   index the index of a value
+     * @return  the value
+     */
+    const_reference operator [] (size_type index) const {
+        return values[index];
+    }
+
+    // --
+    // at
+    // --
+
+    /**
+     * @param   index the index of a value
+     * @return  the value
+     * @throws  out_of_range if the index is greater or equal to size
+     */
+    const_reference at (size_type index) const {
+        return values.at(index);
+    }
+
+    // ----
+    // back
+    // ----
+
+    /**
+     * @returns the newest, and largest, value
+     */
+    const_reference back () const {
+        assert(!empty());
+        return values.back();
+    }
+
+    // -----
+    // begin
+    // -----
+
+    /**
+     * @returns an iterator pointing to the first value
+     */
+    const_iterator begin () const {
+        return values.begin();
+    }
+
+    // -----
+    // clear
+    // -----
+
+    /**
+     * drop every value
+     */
+    void clear () {
+        values.clear();
+        fences.clear();
+        head = popped = 0;
+    }
+
+    // -----
+    // empty
+    // -----
+
+    /**
+     * @returns true if size == 0
+     */
+    bool empty () const {
+        return values.empty();
+    }
+
+    // ---
+    // end
+    // ---
+
+    /**
+     * @returns an iterator pointing past the last value
+     */
+    const_iterator end () const {
+        return values.end();
+    }
+
+    // -----
+    // front
+    // -----
+
+    /**
+     * @returns the oldest, and smallest, value
+     */
+    const_reference front () const {
+        assert(!empty());
+        return values.front();
+    }
+
+    // -----------
+    // lower_bound
+    // -----------
+
+    /**
+     * @param   v the value to look for
+     * @return  the index of the first value that is not less than v, size() if none
+     */
+    size_type lower_bound (const_reference v) const {
+        return search(v, [] (const T* b, const T* e, const T& w, const value_compare& c) {
+            return std::lower_bound(b, e, w, c);});
+    }
+
+    // ---------
+    // pop_front
+    // ---------
+
+    /**
+     * drop the oldest value, and its row's fence if it was the last value of the row
+     */
+    void pop_front () {
+        assert(!empty());
+        values.pop_front();
+        ++popped;
+        if(fences.size() - head > values.segment_count())
+            ++head;
+        if(2 * head > fences.size()) {
+            fences.erase(fences.begin(), fences.begin() + head);
+            head = 0;
+        }
+        compact();
+        assert(valid());
+    }
+
+    // ---------
+    // push_back
+    // ---------
+
+    /**
+     * add a value at the back, and a fence for it if it starts a row
+     * @param   v a value that is not less than back()
+     */
+    void push_back (const_reference v) {
+        assert(empty() || !less(v, back()));
+        values.push_back(v);
+        if(fences.size() - head < values.segment_count())
+            fences.push_back(v);
+        assert(valid());
+    }
+
+    // ----
+    // size
+    // ----
+
+    /**
+     * @returns the number of values
+     */
+    size_type size () const {
+        return values.size();
+    }
+
+    // -----------
+    // upper_bound
+    // -----------
+
+    /**
+     * @param   v the value to look for
+     * @return  the index of the first value that is greater than v, size() if none
+     */
+    size_type upper_bound (const_reference v) const {
+        return search(v, [] (const T* b, const T* e, const T& w, const value_compare& c) {
+            return std::upper_bound(b, e, w, c);});
+    }
+};
+
+#endif // SortedDeque_h
@@ -0,0 +1,677 @@
+// ----------------------------
+// projects/deque/StaticDeque.h
+// Copyright (C) 2014
+// Taylor Gregston
+// ----------------------------
+
+#ifndef StaticDeque_h
+#define StaticDeque_h
+
+// --------
+// includes
+// --------
+
+#include <algorithm>   // equal, lexicographical_compare
+#include <cassert>     // assert
+#include <cstddef>     // size_t, ptrdiff_t
+#include <iterator>    // bidirectional_iterator_tag
+#include <memory>      // allocator
+#include <new>         // placement new
+#include <stdexcept>   // length_error, out_of_range
+#include <type_traits> // aligned_storage, alignment_of
+#include <utility>     // move
+
+#include "Deque.h"
+
+// ------------
+// static_deque
+// ------------
+
+/**
+ * A deque of at most N values stored inside the object, for code that may not touch the
+ * heap. The slots form a ring, so push and pop at either end are O(1) and never allocate.
+ * It has my_deque's interface; pushing onto a full deque throws length_error.
+ * C++11 only allows constexpr member functions on literal types, and destroying the
+ * values makes this one non-literal, so capacity() and max_size() are the constexpr parts.
+ * swap() swaps the values one by one, O(n).
+ */
+template <typename T, size_t N>
+class static_deque {
+public:
+    // --------
+    // typedefs
+    // --------
+
+    typedef std::allocator<T> allocator_type;   //never used, kept for the same interface
+    typedef T                 value_type;
+
+    typedef size_t            size_type;
+    typedef std::ptrdiff_t    difference_type;
+
+    typedef T*                pointer;
+    typedef const T*          const_pointer;
+
+    typedef T&                reference;
+    typedef const T&          const_reference;
+
+    static_assert(N > 0, "static_deque needs room for at least one value");
+
+public:
+    // -----------
+    // operator ==
+    // -----------
+
+    /**
+     * checks to see if the lhs == rhs
+     * @param   lhs the left hand side in question
+     * @param   rhs the right hand side in question
+     * @return  true if the lhs and rhs have same value and number of items
+     */
+    friend bool operator == (const static_deque& lhs, const static_deque& rhs) {
+        return (lhs.size() == rhs.size()) && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+    }
+
+    // ----------
+    // operator <
+    // ----------
+
+    /**
+     * checks to see if the lhs < rhs
+     * @param   lhs the left hand side in question
+     * @param   rhs the right hand side in question
+     * @return  true if the lhs is less than the rhs
+     */
+    friend bool operator < (const static_deque& lhs, const static_deque& rhs) {
+        return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+
+private:
+    // ----
+    // data
+    // ----
+
+    typename std::aligned_storage<sizeof(T), std::alignment_of<T>::value>::type slots[N];
+    size_t head;        //slot of index 0
+    size_t deque_size;  //how many values are in here
+
+private:
+    // -----
+    // valid
+    // -----
+
+    bool valid () const {
+        return (head < N) && (deque_size <= N);
+    }
+
+    /**
+     * @param   i a slot number below 2 * N
+     * @return  i folded back into the ring
+     */
+    static size_t wrap (size_t i) {
+        return i >= N ? i - N : i;
+    }
+
+    /**
+     * @return  the slot holding index i
+     */
+    T* slot (size_t i) {
+        return reinterpret_cast<T*>(&slots[wrap(head + i)]);
+    }
+
+    const T* slot (size_t i) const {
+        return reinterpret_cast<const T*>(&slots[wrap(head + i)]);
+    }
+
+public:
+    // --------
+    // iterator
+    // --------
+
+    template <typename Q, typename P, typename R>
+    class basic_iterator {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef std::bidirectional_iterator_tag        iterator_category;
+        typedef typename static_deque::value_type      value_type;
+        typedef typename static_deque::difference_type difference_type;
+        typedef P                                      pointer;
+        typedef R                                      reference;
+
+    public:
+        /**
+         * checks to see if the lhs == rhs
+         * @param   lhs the left hand side in question
+         * @param   rhs the right hand side in question
+         * @return  true if the lhs and rhs point to the same value
+         */
+        friend bool operator == (const basic_iterator& lhs, const basic_iterator& rhs) {
+            return (lhs.owner == rhs.owner) && (lhs.index == rhs.index);
+        }
+
+        /**
+         * checks to see if the lhs != rhs
+         * @param   lhs the left hand side in question
+         * @param   rhs the right hand side in question
+         * @return  false if the lhs and rhs point to the same value
+         */
+        friend bool operator != (const basic_iterator& lhs, const basic_iterator& rhs) {
+            return !(lhs == rhs);
+        }
+
+        /**
+         * adds a value to the iterator
+         * @param   lhs the iterator to add to
+         * @param   rhs the amount to add
+         * @return  the iterator with its new value
+         */
+        friend basic_iterator operator + (basic_iterator lhs, difference_type rhs) {
+            return lhs += rhs;
+        }
+
+        /**
+         * subtracts a value from the iterator
+         * @param   lhs the iterator to subtract from
+         * @param   rhs the amount to subtract
+         * @return  the iterator with its new value
+         */
+        friend basic_iterator operator - (basic_iterator lhs, difference_type rhs) {
+            return lhs -= rhs;
+        }
+
+    private:
+        // ----
+        // data
+        // ----
+
+        Q* owner;
+        size_t index;   //index from the front, not a slot
+
+        friend class static_deque;
+
+    public:
+        /**
+         * creates an iterator at index_
+         * @param   owner_ the underlying container
+         * @param   index_ the index from the front
+         */
+        basic_iterator (Q* owner_, size_t index_) :
+        owner(owner_), index(index_)
+        {}
+
+        /**
+         * dereference this iterator
+         * @returns the value at which this iterator is pointing
+         */
+        reference operator * () const {
+            return *owner->slot(index);
+        }
+
+        /**
+         * dereference pointer this iterator
+         * @returns a pointer to the value
+         */
+        pointer operator -> () const {
+            return owner->slot(index);
+        }
+
+        /**
+         * increment (pre) this iterator by one
+         * @returns iterator with its NEW value
+         */
+        basic_iterator& operator ++ () {
+            ++index;
+            return *this;
+        }
+
+        /**
+         * increment (post) this iterator by one
+         * @returns iterator with its OLD value
+         */
+        basic_iterator operator ++ (int) {
+            basic_iterator x = *this;
+            ++(*this);
+            return x;
+        }
+
+        /**
+         * decrement (pre) this iterator by one
+         * @returns iterator with its NEW value
+         */
+        basic_iterator& operator -- () {
+            --index;
+            return *this;
+        }
+
+        /**
+         * decrement (post) this iterator by one
+         * @returns iterator with its OLD value
+         */
+        basic_iterator operator -- (int) {
+            basic_iterator x = *this;
+            --(*this);
+            return x;
+        }
+
+        /**
+         * increment this iterator by d
+         * @param d the value to increment by
+         * @returns iterator with its NEW value
+         */
+        basic_iterator& operator += (difference_type d) {
+            index += d;
+            return *this;
+        }
+
+        /**
+         * decrement this iterator by d
+         * @param d the value to decrement by
+         * @returns iterator with its NEW value
+         */
+        basic_iterator& operator -= (difference_type d) {
+            index -= d;
+            return *this;
+        }
+    };
+
+    typedef basic_iterator<static_deque, pointer, reference>                   iterator;
+    typedef basic_iterator<const static_deque, const_pointer, const_reference> const_iterator;
+
+public:
+    // ------------
+    // constructors
+    // ------------
+
+    /**
+     * create an empty static_deque
+     */
+    static_deque () :
+    head(0), deque_size(0)
+    {}
+
+    /**
+     * create a static_deque of size s, filled with v
+     * @param   s the size of the deque to be created
+     * @param   v the value that should be filled into all values (optional)
+     * @throws  length_error if s > N
+     */
+    explicit static_deque (size_type s, const_reference v = value_type()) :
+    head(0), deque_size(0)
+    {
+        if(s > N)
+            throw std::length_error("static_deque full");
+        resize(s, v);
+    }
+
+    /**
+     * create a static_deque containing the same values as that
+     * @param   that the deque to be replicated
+     */
+    static_deque (const static_deque& that) :
+    head(0), deque_size(0)
+    {
+        try {
+            for(size_t i = 0; i < that.deque_size; ++i)
+                push_back(that[i]);
+        }
+        catch (...) {
+            clear();
+            throw;}
+    }
+
+    // ----------
+    // destructor
+    // ----------
+
+    /**
+     * destroy every value, there is nothing to free
+     */
+    ~static_deque () {
+        clear();
+    }
+
+    // ----------
+    // operator =
+    // ----------
+
+    /**
+     * assignment operator, will set this to have values equivalent of rhs
+     * @param rhs the deque that is to be replicated into this
+     * @returns this
+     */
+    static_deque& operator = (const static_deque& rhs) {
+        if(this == &rhs)
+            return *this;
+        size_t common = std::min(deque_size, rhs.deque_size);
+        for(size_t i = 0; i < common; ++i)
+            (*this)[i] = rhs[i];
+        while(deque_size > rhs.deque_size)
+            pop_back();
+        for(size_t i = common; i < rhs.deque_size; ++i)
+            push_back(rhs[i]);
+        return *this;
+    }
+
+    // -----------
+    // operator []
+    // -----------
+
+    /**
+     * index this deque
+     * @param index the index in this deque to be evaluated
+     * @return a reference to the value at index in this deque
+     */
+    reference operator [] (size_type index) {
+        return *slot(index);
+    }
+
+    /**
+     * index this deque, does not allow write
+     * @param index the index in this deque to be evaluated
+     * @return a reference to the value at index in this deque (read only)
+     */
+    const_reference operator [] (size_type index) const {
+        return *slot(index);
+    }
+
+    // --
+    // at
+    // --
+
+    /**
+     * index this deque
+     * @param index the index in this deque to be evaluated
+     * @return a reference to the value at index in this deque
+     * @throws out_of_range if the index is greater or equal to size
+     */
+    reference at (size_type index) {
+        if(index >= deque_size)
+            throw std::out_of_range("at index out of range");
+        return (*this)[index];
+    }
+
+    /**
+     * index this deque (read only)
+     * @param index the index in this deque to be evaluated
+     * @return a reference to the value at index in this deque
+     * @throws out_of_range if the index is greater or equal to size
+     */
+    const_reference at (size_type index) const {
+        return const_cast<static_deque*>(this)->at(index);
+    }
+
+    // -----
+    // front
+    // -----
+
+    /**
+     * @returns the reference to the element at the front of the deque
+     */
+    reference front () {
+        return *slot(0);
+    }
+
+    const_reference front () const {
+        return *slot(0);
+    }
+
+    // ----
+    // back
+    // ----
+
+    /**
+     * @returns the reference to the element at the back of the deque
+     */
+    reference back () {
+        return *slot(deque_size - 1);
+    }
+
+    const_reference back () const {
+        return *slot(deque_size - 1);
+    }
+
+    // -----
+    // begin
+    // -----
+
+    /**
+     * @returns an iterator pointing to the first value
+     */
+    iterator begin () {
+        return iterator(this, 0);
+    }
+
+    const_iterator begin () const {
+        return const_iterator(this, 0);
+    }
+
+    // --------
+    // capacity
+    // --------
+
+    /**
+     * @returns N, the most values this deque can hold
+     */
+    static constexpr size_type capacity () {
+        return N;
+    }
+
+    // -----
+    // clear
+    // -----
+
+    /**
+     * destroy every value
+     */
+    void clear () {
+        while(deque_size)
+            pop_back();
+        head = 0;
+    }
+
+    // -----
+    // empty
+    // -----
+
+    /**
+     * @returns true if size == 0
+     */
+    bool empty () const {
+        return !deque_size;
+    }
+
+    // ---
+    // end
+    // ---
+
+    /**
+     * @returns an iterator pointing past the last value
+     */
+    iterator end () {
+        return iterator(this, deque_size);
+    }
+
+    const_iterator end () const {
+        return const_iterator(this, deque_size);
+    }
+
+    // -----
+    // erase
+    // -----
+
+    /**
+     * erase a value, shifting whichever side of it is shorter
+     * @param remove the value to erase
+     * @return an iterator pointing to the value after the one erased
+     */
+    iterator erase (iterator remove) {
+        size_t k = remove.index;
+        assert(k < deque_size);
+        if(k < deque_size / 2) {
+            for(size_t j = k; j > 0; --j)
+                (*this)[j] = std::move((*this)[j - 1]);
+            pop_front();
+        }
+        else {
+            for(size_t j = k; j + 1 < deque_size; ++j)
+                (*this)[j] = std::move((*this)[j + 1]);
+            pop_back();
+        }
+        assert(valid());
+        return iterator(this, k);
+    }
+
+    // ------
+    // insert
+    // ------
+
+    /**
+     * insert a value before spot, shifting whichever side of it is shorter
+     * @param spot where to insert the value
+     * @param ins the value to be inserted
+     * @return an iterator pointing to the value inserted
+     * @throws length_error if the deque is full
+     */
+    iterator insert (iterator spot, const_reference ins) {
+        size_t k = spot.index;
+        assert(k <= deque_size);
+        value_type v(ins);  //ins may be one of the values that moves
+        if(k < deque_size / 2) {
+            if(!k) {
+                push_front(v);
+                return begin();
+            }
+            push_front(front());
+            for(size_t j = 1; j < k; ++j)
+                (*this)[j] = std::move((*this)[j + 1]);
+        }
+        else {
+            if(k == deque_size) {
+                push_back(v);
+                return iterator(this, k);
+            }
+            push_back(back());
+            for(size_t j = deque_size - 2; j > k; --j)
+                (*this)[j] = std::move((*this)[j - 1]);
+        }
+        (*this)[k] = std::move(v);
+        assert(valid());
+        return iterator(this, k);
+    }
+
+    // --------
+    // max_size
+    // --------
+
+    /**
+     * @returns N, the most values this deque can hold
+     */
+    static constexpr size_type max_size () {
+        return N;
+    }
+
+    // ---
+    // pop
+    // ---
+
+    /**
+     * removes (destroys) the value at the back of the deque
+     */
+    void pop_back () {
+        assert(!empty());
+        --deque_size;
+        slot(deque_size)->~T();
+        assert(valid());
+    }
+
+    /**
+     * removes (destroys) the value at the front of the deque
+     */
+    void pop_front () {
+        assert(!empty());
+        slot(0)->~T();
+        head = wrap(head + 1);
+        --deque_size;
+        assert(valid());
+    }
+
+    // ----
+    // push
+    // ----
+
+    /**
+     * push a value onto the back side of this deque
+     * @param val the value to add to the deque
+     * @throws length_error if the deque is full
+     */
+    void push_back (const_reference val) {
+        if(deque_size == N)
+            throw std::length_error("static_deque full");
+        new (slot(deque_size)) T(val);
+        ++deque_size;
+        assert(valid());
+    }
+
+    /**
+     * push a value onto the front side of this deque
+     * @param val the value to add to the deque
+     * @throws length_error if the deque is full
+     */
+    void push_front (const_reference val) {
+        if(deque_size == N)
+            throw std::length_error("static_deque full");
+        size_t h = wrap(head + N - 1);
+        new (reinterpret_cast<T*>(&slots[h])) T(val);
+        head = h;
+        ++deque_size;
+        assert(valid());
+    }
+
+    // ------
+    // resize
+    // ------
+
+    /**
+     * resize this deque to a given amount
+     * @param s the number of elements this deque should hold
+     * @param v the value to fill any extra slots with
+     * @throws length_error if s > N
+     */
+    void resize (size_type s, const_reference v = value_type()) {
+        if(s > N)
+            throw std::length_error("static_deque full");
+        while(deque_size > s)
+            pop_back();
+        while(deque_size < s)
+            push_back(v);
+    }
+
+    // ----
+    // size
+    // ----
+
+    /**
+     * @returns the number of elements in this deque
+     */
+    size_type size () const {
+        return deque_size;
+    }
+
+    // ----
+    // swap
+    // ----
+
+    /**
+     * swap this deque's values with another, one value at a time
+     * @param other the other deque to be swapped with
+     */
+    void swap (static_deque& other) {
+        static_deque x(*this);
+        *this = other;
+        other = x;
+    }
+};
+
+#endif // StaticDeque_h
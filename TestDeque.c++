@@ -38,15 +38,38 @@ To obtain coverage of the test:
 // --------
 
 #include <algorithm> // equal
+#include <cstdio>    // fileno, fclose, tmpfile
 #include <cstring>   // strcmp
 #include <deque>     // deque
-#include <sstream>   // ostringstream
+#include <functional> // greater
+#include <limits>    // numeric_limits
+#include <set>       // multiset
+#include <sstream>   // istringstream, ostringstream
 #include <stdexcept> // invalid_argument
 #include <string>    // ==
+#include <thread>    // thread
+#include <vector>    // vector
+
+#include <unistd.h>  // lseek
 
 #include "gtest/gtest.h"
 
+#include "CountingAllocator.h"
 #include "Deque.h"
+#include "DequeReclaimer.h"
+#include "DequeTrace.h"
+#include "MinMaxHeap.h"
+#include "NumaAllocator.h"
+#include "PackedDeque.h"
+#include "RecordDeque.h"
+#include "RingDeque.h"
+#include "SlotDeque.h"
+#include "SlidingWindow.h"
+#include "SoaDeque.h"
+#include "SortedDeque.h"
+#include "SnapshotDeque.h"
+#include "StaticDeque.h"
+#include "TreeDeque.h"
 
 
 #define ALL_OF_IT       typedef typename TestFixture::deque_type      deque_type; \
@@ -83,7 +106,10 @@ typedef testing::Types<
             std::deque<int>,
             std::deque<double>,
             my_deque<int>,
-            my_deque<double> >
+            my_deque<double>,
+            my_deque<int, numa_allocator<int> >,
+            static_deque<int, 256>,
+            static_deque<double, 256> >
         my_types;
 
 TYPED_TEST_CASE(TestDeque, my_types);
@@ -2901,33 +2927,2220 @@ TYPED_TEST(TestDeque, const_it_cons_3) {
 }
  
 
+// ------------------
+// TestSnapshotDeque
+// ------------------
 
+TEST(TestSnapshotDeque, push_back_1) {
+    snapshot_deque<int> d;
+    ASSERT_TRUE(d.empty());
+    for(int i = 0; i < 100; ++i)
+        d.push_back(i);
+    ASSERT_EQ(d.size(), 100);
+    ASSERT_EQ(d.back(), 99);
+}
 
+TEST(TestSnapshotDeque, snapshot_1) {
+    snapshot_deque<int> d;
+    for(int i = 0; i < 40; ++i)
+        d.push_back(i);
+    snapshot_deque<int>::reader r(d);
+    snapshot_deque<int>::snapshot s(r);
+    ASSERT_EQ(s.size(), 40);
+    ASSERT_EQ(s[0], 0);
+    ASSERT_EQ(s[39], 39);
+    ASSERT_EQ(s.at(17), 17);
+    try {
+        s.at(40);
+        ASSERT_TRUE(false);
+    } catch (std::out_of_range&) {
+        ASSERT_TRUE(true);
+    }
+}
 
+TEST(TestSnapshotDeque, snapshot_2) {
+    snapshot_deque<int> d;
+    d.push_back(1);
+    snapshot_deque<int>::reader r(d);
+    {
+        snapshot_deque<int>::snapshot s(r);
+        //the writer keeps going and replaces the map several times
+        for(int i = 0; i < 1000; ++i)
+            d.push_back(i);
+        ASSERT_EQ(s.size(), 1);
+        ASSERT_EQ(s[0], 1);
+        ASSERT_GT(d.reclaim(), 0);
+    }
+    ASSERT_EQ(d.reclaim(), 0);
+    snapshot_deque<int>::snapshot s(r);
+    ASSERT_EQ(s.size(), 1001);
+    ASSERT_EQ(s[1000], 999);
+}
 
+TEST(TestSnapshotDeque, iterator_1) {
+    snapshot_deque<int> d;
+    for(int i = 0; i < 50; ++i)
+        d.push_back(i);
+    snapshot_deque<int>::reader r(d);
+    snapshot_deque<int>::snapshot s(r);
+    int sum = 0;
+    for(snapshot_deque<int>::const_iterator it = s.begin(); it != s.end(); ++it)
+        sum += *it;
+    ASSERT_EQ(sum, 1225);
+}
+
+TEST(TestSnapshotDeque, reader_1) {
+    snapshot_deque<int, std::allocator<int>, 2> d;
+    snapshot_deque<int, std::allocator<int>, 2>::reader r1(d);
+    snapshot_deque<int, std::allocator<int>, 2>::reader r2(d);
+    try {
+        snapshot_deque<int, std::allocator<int>, 2>::reader r3(d);
+        ASSERT_TRUE(false);
+    } catch (std::length_error&) {
+        ASSERT_TRUE(true);
+    }
+}
 
+TEST(TestSnapshotDeque, threads_1) {
+    const int NUM_OF_PUSH = 100000;
+    snapshot_deque<int> d;
+    std::vector<std::thread> readers;
+    std::atomic<int> bad(0);
+    for(int t = 0; t < 4; ++t)
+        readers.push_back(std::thread([&d, &bad] () {
+            snapshot_deque<int>::reader r(d);
+            size_t last = 0;
+            while(last < NUM_OF_PUSH) {
+                snapshot_deque<int>::snapshot s(r);
+                if(s.size() < last)
+                    ++bad;
+                last = s.size();
+                if(last && (s[last - 1] != (int)(last - 1) || s[last >> 1] != (int)(last >> 1)))
+                    ++bad;
+            }
+        }));
+    for(int i = 0; i < NUM_OF_PUSH; ++i)
+        d.push_back(i);
+    for(size_t t = 0; t < readers.size(); ++t)
+        readers[t].join();
+    ASSERT_EQ(bad.load(), 0);
+    ASSERT_EQ(d.reclaim(), 0);
+}
 
+// --------------
+// TestSlotDeque
+// --------------
 
+TEST(TestSlotDeque, insert_1) {
+    slot_deque<int> d;
+    ASSERT_TRUE(d.empty());
+    slot_deque<int>::handle h = d.insert(7);
+    ASSERT_EQ(d.size(), 1);
+    ASSERT_TRUE(d.contains(h));
+    ASSERT_EQ(d[h], 7);
+    ASSERT_EQ(*d.get(h), 7);
+}
+
+TEST(TestSlotDeque, insert_2) {
+    slot_deque<int> d;
+    std::vector<slot_deque<int>::handle> h;
+    std::vector<int*> p;
+    for(int i = 0; i < 100; ++i) {
+        h.push_back(d.insert(i));
+        p.push_back(d.get(h.back()));
+    }
+    //addresses survive growth
+    for(int i = 0; i < 100; ++i) {
+        ASSERT_EQ(d.get(h[i]), p[i]);
+        ASSERT_EQ(*p[i], i);
+    }
+    ASSERT_EQ(d.capacity(), 112);
+}
 
+TEST(TestSlotDeque, erase_1) {
+    slot_deque<int> d;
+    slot_deque<int>::handle a = d.insert(1);
+    slot_deque<int>::handle b = d.insert(2);
+    ASSERT_TRUE(d.erase(a));
+    ASSERT_FALSE(d.erase(a));
+    ASSERT_FALSE(d.contains(a));
+    ASSERT_TRUE(d.get(a) == NULL);
+    ASSERT_EQ(d.size(), 1);
+    ASSERT_EQ(d[b], 2);
+}
+
+TEST(TestSlotDeque, erase_2) {
+    slot_deque<int> d;
+    slot_deque<int>::handle a = d.insert(1);
+    d.erase(a);
+    //the slot is reused, the old handle stays stale
+    slot_deque<int>::handle b = d.insert(2);
+    ASSERT_EQ(a.index, b.index);
+    ASSERT_TRUE(a != b);
+    ASSERT_FALSE(d.contains(a));
+    try {
+        d.at(a);
+        ASSERT_TRUE(false);
+    } catch (std::out_of_range&) {
+        ASSERT_TRUE(true);
+    }
+    ASSERT_EQ(d.at(b), 2);
+}
+
+TEST(TestSlotDeque, iterator_1) {
+    slot_deque<int> d;
+    std::vector<slot_deque<int>::handle> h;
+    for(int i = 0; i < 64; ++i)
+        h.push_back(d.insert(i));
+    //leave whole empty rows and scattered holes
+    for(int i = 0; i < 64; ++i)
+        if((i >= 16 && i < 48) || (i % 3 == 0))
+            d.erase(h[i]);
+    std::vector<int> seen;
+    const slot_deque<int>& c = d;
+    for(slot_deque<int>::const_iterator it = c.begin(); it != c.end(); ++it)
+        seen.push_back(*it);
+    ASSERT_EQ(seen.size(), d.size());
+    for(size_t i = 0; i < seen.size(); ++i) {
+        ASSERT_TRUE(seen[i] % 3 != 0);
+        ASSERT_TRUE(seen[i] < 16 || seen[i] >= 48);
+    }
+    ASSERT_TRUE(d.begin().to_handle() == h[1]);
+}
 
+TEST(TestSlotDeque, clear_1) {
+    slot_deque<std::string> d;
+    slot_deque<std::string>::handle a = d.insert("abc");
+    d.insert("def");
+    d.clear();
+    ASSERT_TRUE(d.empty());
+    ASSERT_FALSE(d.contains(a));
+    ASSERT_TRUE(d.begin() == d.end());
+    d.insert("ghi");
+    ASSERT_EQ(*d.begin(), "ghi");
+}
 
+// -------------
+// TestBoolDeque
+// -------------
 
+template <typename D>
+struct TestBoolDeque : TestDeque<D> {};
 
+typedef testing::Types<
+            std::deque<bool>,
+            my_deque<bool> >
+        bool_types;
 
+TYPED_TEST_CASE(TestBoolDeque, bool_types);
 
+TYPED_TEST(TestBoolDeque, push_back_1) {
+    ALL_OF_IT
+    deque_type d;
+    ASSERT_TRUE(d.empty());
+    d.push_back(true);
+    d.push_back(false);
+    d.push_back(true);
+    ASSERT_EQ(d.size(), 3);
+    ASSERT_TRUE(d[0]);
+    ASSERT_FALSE(d[1]);
+    ASSERT_TRUE(d[2]);
+}
 
+TYPED_TEST(TestBoolDeque, push_back_2) {
+    ALL_OF_IT
+    deque_type d;
+    for(int i = 0; i < 5000; ++i)
+        d.push_back(i % 3 == 0);
+    for(int i = 0; i < 5000; ++i)
+        ASSERT_EQ(d[i], i % 3 == 0);
+}
 
+TYPED_TEST(TestBoolDeque, push_front_1) {
+    ALL_OF_IT
+    deque_type d;
+    for(int i = 0; i < 5000; ++i)
+        d.push_front(i % 7 == 0);
+    ASSERT_EQ(d.size(), 5000);
+    for(int i = 0; i < 5000; ++i)
+        ASSERT_EQ(d[4999 - i], i % 7 == 0);
+}
 
+TYPED_TEST(TestBoolDeque, pop_front_1) {
+    ALL_OF_IT
+    deque_type d;
+    for(int i = 0; i < 3000; ++i)
+        d.push_back(i & 1);
+    for(int i = 0; i < 2000; ++i)
+        d.pop_front();
+    ASSERT_EQ(d.size(), 1000);
+    ASSERT_FALSE(d.front());
+    ASSERT_TRUE(d[1]);
+}
 
+TYPED_TEST(TestBoolDeque, pop_back_1) {
+    ALL_OF_IT
+    deque_type d;
+    d.push_back(true);
+    d.push_back(false);
+    d.pop_back();
+    ASSERT_EQ(d.size(), 1);
+    ASSERT_TRUE(d.back());
+}
 
+TYPED_TEST(TestBoolDeque, slide_1) {
+    ALL_OF_IT
+    deque_type d;
+    //a queue that keeps sliding along its map
+    for(int i = 0; i < 20000; ++i) {
+        d.push_back(i % 5 == 0);
+        if(d.size() > 100)
+            d.pop_front();
+    }
+    ASSERT_EQ(d.size(), 100);
+    for(int i = 0; i < 100; ++i)
+        ASSERT_EQ(d[i], (19900 + i) % 5 == 0);
+}
 
+TYPED_TEST(TestBoolDeque, reference_1) {
+    ALL_OF_IT
+    deque_type d(70, false);
+    d[65] = true;
+    d.front() = true;
+    d.back() = d[65];
+    ASSERT_TRUE(d[0]);
+    ASSERT_TRUE(d[65]);
+    ASSERT_TRUE(d[69]);
+    ASSERT_FALSE(d[64]);
+}
 
+TYPED_TEST(TestBoolDeque, at_1) {
+    ALL_OF_IT
+    deque_type d(3, true);
+    ASSERT_TRUE(d.at(2));
+    try {
+        d.at(3);
+        ASSERT_TRUE(false);
+    } catch (std::out_of_range&) {
+        ASSERT_TRUE(true);
+    }
+}
 
+TYPED_TEST(TestBoolDeque, iterator_1) {
+    ALL_OF_IT
+    deque_type d;
+    for(int i = 0; i < 200; ++i)
+        d.push_back(i % 4 == 1);
+    int n = 0;
+    for(typename deque_type::iterator it = d.begin(); it != d.end(); ++it)
+        n += *it;
+    ASSERT_EQ(n, 50);
+    const deque_type& c = d;
+    typename deque_type::const_iterator it = c.end();
+    --it;
+    ASSERT_FALSE(*it);
+    it -= 2;
+    ASSERT_TRUE(*it);
+}
 
+TYPED_TEST(TestBoolDeque, constructor_that_1) {
+    ALL_OF_IT
+    deque_type d;
+    for(int i = 0; i < 300; ++i)
+        d.push_front(i % 3 == 2);
+    const deque_type e(d);
+    ASSERT_TRUE(d == e);
+    ASSERT_EQ(e.size(), 300);
+}
 
+TYPED_TEST(TestBoolDeque, assignment_1) {
+    ALL_OF_IT
+    deque_type d(100, true);
+    deque_type e(3000, false);
+    e = d;
+    ASSERT_TRUE(d == e);
+    d = deque_type(5000, false);
+    ASSERT_EQ(d.size(), 5000);
+    ASSERT_FALSE(d[4999]);
+}
 
+TYPED_TEST(TestBoolDeque, swap_1) {
+    ALL_OF_IT
+    deque_type d(10, true);
+    deque_type e(20, false);
+    d.swap(e);
+    ASSERT_EQ(d.size(), 20);
+    ASSERT_EQ(e.size(), 10);
+    ASSERT_TRUE(e[9]);
+}
 
+TYPED_TEST(TestBoolDeque, resize_1) {
+    ALL_OF_IT
+    deque_type d(10, false);
+    d.resize(200, true);
+    ASSERT_FALSE(d[9]);
+    ASSERT_TRUE(d[10]);
+    ASSERT_TRUE(d[199]);
+    d.resize(5);
+    ASSERT_EQ(d.size(), 5);
+}
+
+TYPED_TEST(TestBoolDeque, clear_1) {
+    ALL_OF_IT
+    deque_type d(100, true);
+    d.clear();
+    ASSERT_TRUE(d.empty());
+    d.push_front(true);
+    ASSERT_TRUE(d.front());
+}
+
+TYPED_TEST(TestBoolDeque, erase_1) {
+    ALL_OF_IT
+    deque_type d;
+    for(int i = 0; i < 150; ++i)
+        d.push_back(i % 2 == 0);
+    typename deque_type::iterator it = d.erase(d.begin() + 10);
+    ASSERT_FALSE(*it);
+    ASSERT_EQ(d.size(), 149);
+    for(int i = 10; i < 149; ++i)
+        ASSERT_EQ(d[i], i % 2 == 1);
+}
+
+TYPED_TEST(TestBoolDeque, insert_1) {
+    ALL_OF_IT
+    deque_type d;
+    for(int i = 0; i < 150; ++i)
+        d.push_back(i % 2 == 0);
+    typename deque_type::iterator it = d.insert(d.begin() + 3, true);
+    ASSERT_TRUE(*it);
+    ASSERT_EQ(d.size(), 151);
+    ASSERT_TRUE(d[2]);
+    ASSERT_TRUE(d[3]);
+    for(int i = 4; i < 151; ++i)
+        ASSERT_EQ(d[i], i % 2 == 1);
+}
+
+TYPED_TEST(TestBoolDeque, compare_1) {
+    ALL_OF_IT
+    deque_type d(5, false);
+    deque_type e(5, false);
+    ASSERT_TRUE(d == e);
+    e[4] = true;
+    ASSERT_TRUE(d != e);
+    ASSERT_TRUE(d < e);
+    ASSERT_FALSE(e < d);
+}
+
+TEST(TestBoolDeque, count_1) {
+    my_deque<bool> d;
+    std::deque<bool> x;
+    for(int i = 0; i < 3000; ++i) {
+        d.push_back(i % 3 == 0);
+        x.push_back(i % 3 == 0);
+    }
+    for(int i = 0; i < 77; ++i) {
+        d.pop_front();
+        x.pop_front();
+    }
+    ASSERT_EQ(d.count(), (size_t)std::count(x.begin(), x.end(), true));
+    ASSERT_EQ(d.count(false), (size_t)std::count(x.begin(), x.end(), false));
+}
+
+TEST(TestBoolDeque, find_first_1) {
+    my_deque<bool> d(5000, false);
+    ASSERT_EQ(d.find_first(), 5000);
+    ASSERT_EQ(d.find_first(false), 0);
+    d[4321] = true;
+    ASSERT_EQ(d.find_first(), 4321);
+    d.push_front(true);
+    ASSERT_EQ(d.find_first(), 0);
+    d.pop_front();
+    ASSERT_EQ(d.find_first(), 4321);
+}
+
+TEST(TestBoolDeque, push_back_n_1) {
+    my_deque<bool> d;
+    d.push_back(true);
+    d.push_back_n(1000, false);
+    d.push_back_n(3, true);
+    d.push_back_n(0, true);
+    ASSERT_EQ(d.size(), 1004);
+    ASSERT_EQ(d.count(), 4);
+    ASSERT_EQ(d.find_first(), 0);
+    d.pop_front();
+    ASSERT_EQ(d.find_first(), 1000);
+}
+
+TEST(TestBoolDeque, mixed_1) {
+    my_deque<bool> d;
+    std::deque<bool> x;
+    unsigned r = 12345;
+    for(int i = 0; i < 50000; ++i) {
+        r = r * 1103515245 + 12345;
+        bool v = (r >> 16) & 1;
+        switch((r >> 20) % 5) {
+        case 0: d.push_back(v);  x.push_back(v);  break;
+        case 1: d.push_front(v); x.push_front(v); break;
+        case 2: if(!x.empty()) {d.pop_front(); x.pop_front();} break;
+        case 3: if(!x.empty()) {d.pop_back();  x.pop_back();}  break;
+        case 4: d.push_back_n((r >> 8) % 200, v); x.insert(x.end(), (r >> 8) % 200, v); break;
+        }
+    }
+    ASSERT_EQ(d.size(), x.size());
+    ASSERT_TRUE(std::equal(x.begin(), x.end(), d.begin()));
+}
 
+// ------------
+// TestSoaDeque
+// ------------
 
+TEST(TestSoaDeque, push_back_1) {
+    soa_deque<long long, int, double> d;
+    ASSERT_TRUE(d.empty());
+    d.push_back(100, 1, 2.5);
+    d.push_back(std::make_tuple(200LL, 2, 3.5));
+    ASSERT_EQ(d.size(), 2);
+    ASSERT_EQ(d.get<0>(0), 100);
+    ASSERT_EQ(d.get<1>(1), 2);
+    ASSERT_EQ(d.get<2>(1), 3.5);
+    ASSERT_TRUE(d[0] == std::make_tuple(100LL, 1, 2.5));
+}
+
+TEST(TestSoaDeque, push_front_1) {
+    soa_deque<int, std::string> d;
+    for(int i = 0; i < 1000; ++i)
+        d.push_front(i, std::to_string(i));
+    ASSERT_EQ(d.size(), 1000);
+    ASSERT_EQ(d.get<0>(0), 999);
+    ASSERT_EQ(d.get<1>(999), "0");
+    d.get<1>(0) = "x";
+    ASSERT_EQ(std::get<1>(d.at(0)), "x");
+    try {
+        d.at(1000);
+        ASSERT_TRUE(false);
+    } catch (std::out_of_range&) {
+        ASSERT_TRUE(true);
+    }
+}
+
+TEST(TestSoaDeque, pop_1) {
+    soa_deque<int, std::string> d;
+    for(int i = 0; i < 2000; ++i) {
+        d.push_back(i, std::to_string(i));
+        if(d.size() > 300)
+            d.pop_front();
+    }
+    d.pop_back();
+    ASSERT_EQ(d.size(), 299);
+    ASSERT_EQ(d.get<0>(0), 1700);
+    ASSERT_EQ(d.get<1>(298), "1998");
+}
+
+TEST(TestSoaDeque, segment_1) {
+    soa_deque<int, double> d;
+    for(int i = 0; i < 1000; ++i)
+        d.push_back(i, i * 0.5);
+    d.pop_front();
+    size_t n = 0;
+    int expected = 1;
+    for(size_t s = 0; s < d.segment_count(); ++s) {
+        row_span<int> x = d.segment<0>(s);
+        for(int* p = x.begin(); p != x.end(); ++p)
+            ASSERT_EQ(*p, expected++);
+        n += x.size();
+    }
+    ASSERT_EQ(n, d.size());
+}
+
+TEST(TestSoaDeque, for_each_1) {
+    soa_deque<int, double> d;
+    for(int i = 0; i < 1000; ++i)
+        d.push_back(i, 1.0);
+    struct add {
+        long long total;
+        void operator () (int x) {total += x;}
+    };
+    add a = {0};
+    ASSERT_EQ(d.for_each<0>(a).total, 499500);
+}
+
+TEST(TestSoaDeque, copy_1) {
+    soa_deque<int, std::string> d;
+    for(int i = 0; i < 600; ++i)
+        d.push_back(i, "s");
+    soa_deque<int, std::string> e(d);
+    soa_deque<int, std::string> f;
+    f = e;
+    d.clear();
+    ASSERT_TRUE(d.empty());
+    ASSERT_EQ(f.size(), 600);
+    ASSERT_EQ(f.get<0>(599), 599);
+}
 
+// -------------
+// TestRingDeque
+// -------------
 
+TEST(TestRingDeque, push_back_1) {
+    ring_deque<int, 4> d;
+    ASSERT_EQ(d.capacity(), 4);
+    ASSERT_TRUE(d.empty());
+    d.push_back(1);
+    d.push_back(2);
+    ASSERT_EQ(d.size(), 2);
+    ASSERT_EQ(d.front(), 1);
+    ASSERT_EQ(d.back(), 2);
+    ASSERT_FALSE(d.full());
+}
+
+TEST(TestRingDeque, push_back_2) {
+    ring_deque<int, 4> d;
+    for(int i = 0; i < 11; ++i)
+        d.push_back(i);
+    ASSERT_TRUE(d.full());
+    ASSERT_EQ(d.size(), 4);
+    ASSERT_EQ(d[0], 7);
+    ASSERT_EQ(d[3], 10);
+    ASSERT_EQ(d.at(1), 8);
+    try {
+        d.at(4);
+        ASSERT_TRUE(false);
+    } catch (std::out_of_range&) {
+        ASSERT_TRUE(true);
+    }
+}
+
+TEST(TestRingDeque, runtime_1) {
+    ring_deque<std::string> d(3);
+    ASSERT_EQ(d.capacity(), 3);
+    d.push_back("a");
+    d.push_back("b");
+    d.push_back("c");
+    d.push_back("d");
+    ASSERT_EQ(d.front(), "b");
+    ASSERT_EQ(d.back(), "d");
+    try {
+        ring_deque<int> e(0);
+        ASSERT_TRUE(false);
+    } catch (std::invalid_argument&) {
+        ASSERT_TRUE(true);
+    }
+}
+
+TEST(TestRingDeque, halves_1) {
+    ring_deque<int> d(5);
+    for(int i = 0; i < 3; ++i)
+        d.push_back(i);
+    ASSERT_EQ(d.first_half().size(), 3);
+    ASSERT_EQ(d.second_half().size(), 0);
+    for(int i = 3; i < 8; ++i)
+        d.push_back(i);
+    //window is 3..7, stored as [5 6 7 3 4]
+    row_span<int> a = d.first_half();
+    row_span<int> b = d.second_half();
+    ASSERT_EQ(a.size(), 2);
+    ASSERT_EQ(a[0], 3);
+    ASSERT_EQ(a[1], 4);
+    ASSERT_EQ(b.size(), 3);
+    ASSERT_EQ(b[0], 5);
+    ASSERT_EQ(b[2], 7);
+}
+
+TEST(TestRingDeque, pop_1) {
+    ring_deque<int, 3> d;
+    for(int i = 0; i < 5; ++i)
+        d.push_back(i);
+    d.pop_front();
+    ASSERT_EQ(d.size(), 2);
+    ASSERT_EQ(d.front(), 3);
+    d.pop_back();
+    ASSERT_EQ(d.back(), 3);
+    d.push_back(9);
+    d.push_back(10);
+    ASSERT_EQ(d[0], 3);
+    ASSERT_EQ(d[2], 10);
+    d.clear();
+    ASSERT_TRUE(d.empty());
+}
+
+// -------------
+// TestTreeDeque
+// -------------
+
+TEST(TestTreeDeque, push_back_1) {
+    tree_deque<int> d;
+    ASSERT_TRUE(d.empty());
+    for(int i = 0; i < 5000; ++i)
+        d.push_back(i);
+    ASSERT_EQ(d.size(), 5000);
+    ASSERT_EQ(d.front(), 0);
+    ASSERT_EQ(d.back(), 4999);
+    for(int i = 0; i < 5000; ++i)
+        ASSERT_EQ(d[i], i);
+}
+
+TEST(TestTreeDeque, push_front_1) {
+    tree_deque<int> d;
+    for(int i = 0; i < 5000; ++i)
+        d.push_front(i);
+    ASSERT_EQ(d.front(), 4999);
+    ASSERT_EQ(d.back(), 0);
+    for(int i = 0; i < 5000; ++i)
+        d.pop_back();
+    ASSERT_TRUE(d.empty());
+}
+
+TEST(TestTreeDeque, insert_1) {
+    tree_deque<std::string> d;
+    d.push_back("a");
+    d.push_back("c");
+    d.insert(1, "b");
+    d.insert(3, "d");
+    d.insert(0, "_");
+    ASSERT_EQ(d.size(), 5);
+    ASSERT_EQ(d[0], "_");
+    ASSERT_EQ(d[2], "b");
+    ASSERT_EQ(d[4], "d");
+    d.erase(2);
+    ASSERT_EQ(d[2], "c");
+}
+
+TEST(TestTreeDeque, iterator_1) {
+    tree_deque<int> d;
+    for(int i = 0; i < 1000; ++i)
+        d.insert(d.size() / 2, i);
+    std::deque<int> x;
+    for(int i = 0; i < 1000; ++i)
+        x.insert(x.begin() + x.size() / 2, i);
+    ASSERT_TRUE(std::equal(x.begin(), x.end(), d.begin()));
+    tree_deque<int>::iterator b = d.end();
+    std::deque<int>::iterator y = x.end();
+    while(b != d.begin()) {
+        ASSERT_EQ(*--b, *--y);
+    }
+}
+
+TEST(TestTreeDeque, copy_1) {
+    tree_deque<int> d(300, 7);
+    tree_deque<int> e(d);
+    ASSERT_TRUE(d == e);
+    e[150] = 8;
+    ASSERT_TRUE(d < e);
+    d = e;
+    ASSERT_TRUE(d == e);
+    d.clear();
+    ASSERT_TRUE(d.empty());
+    ASSERT_EQ(e.size(), 300);
+}
+
+TEST(TestTreeDeque, at_1) {
+    tree_deque<int> d(10, 1);
+    ASSERT_EQ(d.at(9), 1);
+    try {
+        d.at(10);
+        ASSERT_TRUE(false);
+    } catch (std::out_of_range&) {
+        ASSERT_TRUE(true);
+    }
+}
+
+TEST(TestTreeDeque, mixed_1) {
+    tree_deque<int> d;
+    std::deque<int> x;
+    unsigned r = 777;
+    for(int i = 0; i < 100000; ++i) {
+        r = r * 1103515245 + 12345;
+        size_t p = x.empty() ? 0 : (r >> 4) % (x.size() + 1);
+        //grow for a while, then shrink, so both splits and merges happen
+        bool grow = ((i / 20000) & 1) ? ((r >> 28) < 5) : ((r >> 28) < 11);
+        if(grow || x.empty()) {
+            d.insert(p, i);
+            x.insert(x.begin() + p, i);
+        }
+        else {
+            p = p % x.size();
+            d.erase(p);
+            x.erase(x.begin() + p);
+        }
+    }
+    ASSERT_EQ(d.size(), x.size());
+    ASSERT_TRUE(std::equal(x.begin(), x.end(), d.begin()));
+    for(size_t i = 0; i < x.size(); i += 97)
+        ASSERT_EQ(d[i], x[i]);
+}
+
+// --------------
+// TestMinMaxHeap
+// --------------
+
+TEST(TestMinMaxHeap, push_1) {
+    minmax_heap<int> h;
+    ASSERT_TRUE(h.empty());
+    h.push(5);
+    ASSERT_EQ(h.min(), 5);
+    ASSERT_EQ(h.max(), 5);
+    h.push(9);
+    h.push(1);
+    h.push(7);
+    ASSERT_EQ(h.size(), 4);
+    ASSERT_EQ(h.min(), 1);
+    ASSERT_EQ(h.max(), 9);
+}
+
+TEST(TestMinMaxHeap, pop_1) {
+    minmax_heap<int> h;
+    for(int i = 0; i < 100; ++i)
+        h.push((i * 37) % 100);
+    for(int i = 0; i < 50; ++i) {
+        ASSERT_EQ(h.min(), i);
+        ASSERT_EQ(h.max(), 99 - i);
+        h.pop_min();
+        h.pop_max();
+    }
+    ASSERT_TRUE(h.empty());
+}
+
+TEST(TestMinMaxHeap, heapify_1) {
+    int a[] = {4, 8, 1, 9, 3, 3, 7, 0, 6, 2, 5};
+    minmax_heap<int> h(a, a + 11);
+    ASSERT_EQ(h.size(), 11);
+    int last = -1;
+    while(!h.empty()) {
+        ASSERT_LE(last, h.min());
+        last = h.min();
+        h.pop_min();
+    }
+    ASSERT_EQ(last, 9);
+}
+
+TEST(TestMinMaxHeap, compare_1) {
+    minmax_heap<std::string, std::greater<std::string> > h;
+    h.push("b");
+    h.push("a");
+    h.push("c");
+    ASSERT_EQ(h.min(), "c");
+    ASSERT_EQ(h.max(), "a");
+}
+
+TEST(TestMinMaxHeap, container_1) {
+    minmax_heap<int, std::less<int>, std::deque<int> > h;
+    minmax_heap<int> g;
+    for(int i = 0; i < 20; ++i) {
+        h.push(i);
+        g.push(i);
+    }
+    h.pop_max();
+    g.pop_max();
+    ASSERT_EQ(h.max(), g.max());
+    g.swap(g);
+    ASSERT_EQ(g.size(), 19);
+}
+
+TEST(TestMinMaxHeap, mixed_1) {
+    minmax_heap<int> h;
+    std::multiset<int> x;
+    unsigned r = 99;
+    for(int i = 0; i < 50000; ++i) {
+        r = r * 1103515245 + 12345;
+        int v = (r >> 8) % 1000;
+        switch((r >> 28) % 4) {
+        case 0: case 1: h.push(v); x.insert(v); break;
+        case 2: if(!x.empty()) {h.pop_min(); x.erase(x.begin());} break;
+        case 3: if(!x.empty()) {h.pop_max(); x.erase(--x.end());} break;
+        }
+        ASSERT_EQ(h.size(), x.size());
+        if(!x.empty()) {
+            ASSERT_EQ(h.min(), *x.begin());
+            ASSERT_EQ(h.max(), *x.rbegin());
+        }
+    }
+    std::vector<int> y(x.begin(), x.end());
+    minmax_heap<int> g(y.rbegin(), y.rend());
+    for(size_t i = 0; i < y.size(); ++i) {
+        ASSERT_EQ(g.max(), y[y.size() - 1 - i]);
+        g.pop_max();
+    }
+}
+
+// -----------------
+// TestSlidingWindow
+// -----------------
+
+TEST(TestSlidingWindow, push_back_1) {
+    sliding_window<int> w;
+    ASSERT_TRUE(w.empty());
+    w.push_back(1, 5);
+    w.push_back(2, 3);
+    w.push_back(3, 8);
+    ASSERT_EQ(w.size(), 3);
+    ASSERT_EQ(w.min(), 3);
+    ASSERT_EQ(w.max(), 8);
+    ASSERT_EQ(w.sum(), 16);
+    ASSERT_EQ(w.front_stamp(), 1);
+}
+
+TEST(TestSlidingWindow, evict_1) {
+    sliding_window<int> w;
+    w.push_back(10, 1);
+    w.push_back(11, 9);
+    w.push_back(12, 4);
+    w.push_back(12, 2);
+    ASSERT_EQ(w.evict_front_until(12), 2);
+    ASSERT_EQ(w.min(), 2);
+    ASSERT_EQ(w.max(), 4);
+    ASSERT_EQ(w.sum(), 6);
+    ASSERT_EQ(w.evict_front_until(100), 2);
+    ASSERT_TRUE(w.empty());
+    ASSERT_EQ(w.sum(), 0);
+}
+
+TEST(TestSlidingWindow, pop_front_1) {
+    sliding_window<double> w;
+    w.push_back(0, 2.0);
+    w.push_back(0, 2.0);
+    w.push_back(0, 1.0);
+    w.pop_front();
+    ASSERT_EQ(w.min(), 1.0);
+    ASSERT_EQ(w.max(), 2.0);
+    w.pop_front();
+    ASSERT_EQ(w.max(), 1.0);
+    ASSERT_EQ(w.sum(), 1.0);
+}
+
+TEST(TestSlidingWindow, push_back_n_1) {
+    long long s[] = {1, 2, 3, 4, 5};
+    int v[] = {7, 2, 9, 4, 6};
+    sliding_window<int> w;
+    w.push_back_n(5, s, v);
+    ASSERT_EQ(w.size(), 5);
+    ASSERT_EQ(w.sum(), 28);
+    ASSERT_EQ(w.min(), 2);
+    ASSERT_EQ(w.max(), 9);
+    w.evict_front_until(4);
+    ASSERT_EQ(w.min(), 4);
+    ASSERT_EQ(w.max(), 6);
+    w.clear();
+    ASSERT_TRUE(w.empty());
+}
+
+TEST(TestSlidingWindow, mixed_1) {
+    sliding_window<int> w;
+    std::deque<std::pair<long long, int> > x;
+    unsigned r = 31;
+    long long t = 0;
+    for(int i = 0; i < 100000; ++i) {
+        r = r * 1103515245 + 12345;
+        t += (r >> 30);
+        int v = (int)((r >> 8) % 1000) - 500;
+        w.push_back(t, v);
+        x.push_back(std::make_pair(t, v));
+        long long cutoff = t - (long long)((r >> 4) % 64);
+        w.evict_front_until(cutoff);
+        while(!x.empty() && x.front().first < cutoff)
+            x.pop_front();
+        ASSERT_EQ(w.size(), x.size());
+        if(i % 101 == 0 && !x.empty()) {
+            int lo = x.front().second, hi = lo, sum = 0;
+            for(size_t k = 0; k < x.size(); ++k) {
+                lo = std::min(lo, x[k].second);
+                hi = std::max(hi, x[k].second);
+                sum += x[k].second;
+            }
+            ASSERT_EQ(w.min(), lo);
+            ASSERT_EQ(w.max(), hi);
+            ASSERT_EQ(w.sum(), sum);
+        }
+    }
+}
+
+// ----------------
+// TestRecordDeque
+// ----------------
+
+TEST(TestRecordDeque, push_back_1) {
+    record_deque<> d;
+    ASSERT_TRUE(d.empty());
+    d.push_back("hello", 5);
+    d.push_back("", 0);
+    d.push_back("abc", 3);
+    ASSERT_EQ(d.size(), 3);
+    ASSERT_EQ(d.bytes(), 12 + 4 + 8);
+    row_span<const char> r = d.front();
+    ASSERT_EQ(std::string(r.begin(), r.end()), "hello");
+}
+
+TEST(TestRecordDeque, pop_front_1) {
+    record_deque<> d;
+    d.push_back("one", 3);
+    d.push_back("three", 5);
+    d.pop_front();
+    ASSERT_EQ(std::string(d.front().begin(), d.front().end()), "three");
+    d.pop_front();
+    ASSERT_TRUE(d.empty());
+    ASSERT_EQ(d.bytes(), 0);
+    d.push_back("again", 5);
+    ASSERT_EQ(d.front().size(), 5);
+}
+
+TEST(TestRecordDeque, iterator_1) {
+    record_deque<> d;
+    const char* w[] = {"a", "bb", "ccc", "dddd", "eeeee"};
+    for(int i = 0; i < 5; ++i)
+        d.push_back(w[i], strlen(w[i]));
+    int i = 0;
+    for(record_deque<>::const_iterator it = d.begin(); it != d.end(); ++it, ++i)
+        ASSERT_EQ(std::string((*it).begin(), (*it).end()), w[i]);
+    ASSERT_EQ(i, 5);
+}
+
+TEST(TestRecordDeque, pad_1) {
+    record_deque<> d;
+    std::string big(RECORD_ROW_SIZE - 2 * RECORD_PREFIX, 'x');
+    d.push_back(big.data(), big.size());
+    d.push_back("tail", 4);
+    //"tail" needs 8 bytes but only 4 are left, so it starts the second row
+    ASSERT_EQ(d.bytes(), RECORD_ROW_SIZE + 8);
+    record_deque<>::const_iterator it = d.begin();
+    ASSERT_EQ((*it).size(), big.size());
+    ++it;
+    ASSERT_EQ(std::string((*it).begin(), (*it).end()), "tail");
+    ASSERT_TRUE(++it == d.end());
+    d.pop_front();
+    ASSERT_EQ(d.bytes(), 8);
+}
+
+TEST(TestRecordDeque, length_1) {
+    record_deque<> d;
+    std::string huge(RECORD_ROW_SIZE, 'x');
+    try {
+        d.push_back(huge.data(), huge.size());
+        ASSERT_TRUE(false);
+    } catch (std::length_error&) {
+        ASSERT_TRUE(d.empty());
+    }
+    d.push_back(huge.data(), RECORD_ROW_SIZE - RECORD_PREFIX);
+    ASSERT_EQ(d.bytes(), RECORD_ROW_SIZE);
+}
+
+TEST(TestRecordDeque, mixed_1) {
+    record_deque<> d;
+    std::deque<std::string> x;
+    unsigned r = 5;
+    for(int i = 0; i < 20000; ++i) {
+        r = r * 1103515245 + 12345;
+        if(((r >> 28) < 9) || x.empty()) {
+            std::string s((r >> 8) % 2000 + 20, (char)('a' + i % 26));
+            d.push_back(s.data(), s.size());
+            x.push_back(s);
+        }
+        else {
+            ASSERT_EQ(std::string(d.front().begin(), d.front().end()), x.front());
+            d.pop_front();
+            x.pop_front();
+        }
+    }
+    ASSERT_EQ(d.size(), x.size());
+    std::deque<std::string>::iterator y = x.begin();
+    for(record_deque<>::const_iterator it = d.begin(); it != d.end(); ++it, ++y)
+        ASSERT_EQ(std::string((*it).begin(), (*it).end()), *y);
+    d.clear();
+    ASSERT_TRUE(d.empty());
+}
+
+// ----------------
+// TestPackedDeque
+// ----------------
+
+TEST(TestPackedDeque, push_back_1) {
+    packed_deque<long long> d;
+    ASSERT_TRUE(d.empty());
+    for(long long i = 0; i < 10 * PACKED_ROW_SIZE; ++i)
+        d.push_back(1000000 + 10 * i);
+    ASSERT_EQ(d.size(), 10 * PACKED_ROW_SIZE);
+    //rows 0 and 1 are hot at the front, row 9 and the empty row 10 at the back
+    ASSERT_EQ(d.packed_rows(), 7);
+    for(size_t i = 0; i < d.size(); ++i)
+        ASSERT_EQ(d[i], 1000000 + 10 * (long long)i);
+    ASSERT_EQ(d.front(), 1000000);
+    ASSERT_EQ(d.back(), 1000000 + 10 * (10 * PACKED_ROW_SIZE - 1));
+}
+
+TEST(TestPackedDeque, push_front_1) {
+    packed_deque<int> d;
+    for(int i = 0; i < 8 * PACKED_ROW_SIZE; ++i)
+        d.push_front(-i * 3 + (i & 7));
+    ASSERT_GT(d.packed_rows(), 0);
+    int i = 8 * PACKED_ROW_SIZE;
+    for(packed_deque<int>::const_iterator it = d.begin(); it != d.end(); ++it) {
+        --i;
+        ASSERT_EQ(*it, -i * 3 + (i & 7));
+    }
+}
+
+TEST(TestPackedDeque, random_1) {
+    packed_deque<unsigned long long> d;
+    unsigned long long r = 1;
+    for(int i = 0; i < 8 * PACKED_ROW_SIZE; ++i) {
+        r = r * 6364136223846793005ULL + 1442695040888963407ULL;
+        d.push_back(r);
+    }
+    //random 64 bit values do not get smaller, so every row stays raw
+    ASSERT_EQ(d.packed_rows(), 0);
+    ASSERT_EQ(d.back(), r);
+}
+
+TEST(TestPackedDeque, set_1) {
+    packed_deque<short> d;
+    for(int i = 0; i < 8 * PACKED_ROW_SIZE; ++i)
+        d.push_back((short)(i & 0x7FFF));
+    size_t packed = d.packed_rows();
+    ASSERT_GT(packed, 0);
+    d.set(3 * PACKED_ROW_SIZE + 5, -1);
+    ASSERT_EQ(d.packed_rows(), packed - 1);
+    ASSERT_EQ(d[3 * PACKED_ROW_SIZE + 5], -1);
+    ASSERT_EQ(d.compress_cold(), 1);
+    ASSERT_EQ(d[3 * PACKED_ROW_SIZE + 5], -1);
+    ASSERT_EQ(d[3 * PACKED_ROW_SIZE + 6], 3 * PACKED_ROW_SIZE + 6);
+}
+
+TEST(TestPackedDeque, pop_1) {
+    packed_deque<long long> d;
+    for(long long i = 0; i < 10 * PACKED_ROW_SIZE; ++i)
+        d.push_back(i * i);
+    for(int i = 0; i < 4 * PACKED_ROW_SIZE; ++i)
+        d.pop_front();
+    for(int i = 0; i < 5 * PACKED_ROW_SIZE + 1; ++i)
+        d.pop_back();
+    ASSERT_EQ(d.size(), PACKED_ROW_SIZE - 1);
+    ASSERT_EQ(d.front(), 16LL * PACKED_ROW_SIZE * PACKED_ROW_SIZE);
+    d.push_back(7);
+    ASSERT_EQ(d.back(), 7);
+    try {
+        d.at(PACKED_ROW_SIZE);
+        ASSERT_TRUE(false);
+    } catch (std::out_of_range&) {
+        ASSERT_TRUE(true);
+    }
+    d.clear();
+    ASSERT_TRUE(d.empty());
+}
+
+TEST(TestPackedDeque, mixed_1) {
+    packed_deque<int> d;
+    std::deque<int> x;
+    unsigned r = 17;
+    int v = 0;
+    for(int i = 0; i < 200000; ++i) {
+        r = r * 1103515245 + 12345;
+        v += (int)((r >> 20) % 9) - 2;
+        switch((r >> 28) % 8) {
+        case 0: case 1: case 2: d.push_back(v);  x.push_back(v);  break;
+        case 3: case 4:         d.push_front(v); x.push_front(v); break;
+        case 5: if(!x.empty()) {d.pop_front(); x.pop_front();} break;
+        case 6: if(!x.empty()) {d.pop_back();  x.pop_back();}  break;
+        case 7: if(!x.empty()) {size_t p = r % x.size(); ASSERT_EQ(d[p], x[p]);} break;
+        }
+    }
+    ASSERT_EQ(d.size(), x.size());
+    ASSERT_GT(d.packed_rows(), 0);
+    ASSERT_TRUE(std::equal(x.begin(), x.end(), d.begin()));
+}
+
+// -----------
+// TestDequeIO
+// -----------
+
+/**
+ * strings are written as a length and their bytes
+ */
+template <>
+struct deque_io<std::string> {
+    static const bool bulk = false;
+
+    static void write (std::ostream& out, const std::string& v) {
+        size_t n = v.size();
+        out.write(reinterpret_cast<const char*>(&n), sizeof(n));
+        out.write(v.data(), n);
+    }
+
+    static std::string read (std::istream& in) {
+        size_t n = 0;
+        in.read(reinterpret_cast<char*>(&n), sizeof(n));
+        std::string v(in ? n : 0, ' ');
+        in.read(&v[0], v.size());
+        return v;
+    }
+};
+
+TEST(TestDequeIO, stream_1) {
+    my_deque<int> d;
+    for(int i = 0; i < 100; ++i)
+        d.push_back(i);
+    for(int i = 1; i < 10; ++i)
+        d.push_front(-i);
+    std::stringstream s;
+    d.serialize(s);
+    ASSERT_EQ(s.str().size(), DEQUE_IO_HEADER + 109 * sizeof(int));
+    my_deque<int> e(5, 3);
+    e.deserialize(s);
+    ASSERT_TRUE(d == e);
+    e.push_back(7);
+    e.push_front(8);
+    ASSERT_EQ(e.size(), 111);
+}
+
+TEST(TestDequeIO, stream_2) {
+    my_deque<double> d;
+    std::stringstream s;
+    d.serialize(s);
+    my_deque<double> e(3, 1.5);
+    e.deserialize(s);
+    ASSERT_TRUE(e.empty());
+    e.push_back(2.5);
+    ASSERT_EQ(e.back(), 2.5);
+}
+
+TEST(TestDequeIO, custom_1) {
+    my_deque<std::string> d;
+    for(int i = 0; i < 40; ++i)
+        d.push_back(std::string(i, 'a' + i % 26));
+    std::stringstream s;
+    d.serialize(s);
+    my_deque<std::string> e;
+    e.deserialize(s);
+    ASSERT_TRUE(d == e);
+}
+
+TEST(TestDequeIO, fd_1) {
+    my_deque<long long> d;
+    for(long long i = 0; i < 100000; ++i)
+        d.push_back(i * i);
+    d.pop_front();
+    FILE* f = tmpfile();
+    ASSERT_TRUE(f != NULL);
+    int fd = fileno(f);
+    d.serialize(fd);
+    ASSERT_EQ(lseek(fd, 0, SEEK_CUR), DEQUE_IO_HEADER + 99999 * sizeof(long long));
+    lseek(fd, 0, SEEK_SET);
+    my_deque<long long> e;
+    e.deserialize(fd);
+    fclose(f);
+    ASSERT_TRUE(d == e);
+}
+
+TEST(TestDequeIO, bad_1) {
+    my_deque<int> d(10, 4);
+    std::stringstream s;
+    d.serialize(s);
+    std::string bytes = s.str();
+
+    std::stringstream wrong(bytes);
+    my_deque<double> e;
+    try {
+        e.deserialize(wrong);
+        ASSERT_TRUE(false);
+    } catch (std::runtime_error&) {
+        ASSERT_TRUE(e.empty());
+    }
+
+    std::stringstream cut(bytes.substr(0, bytes.size() - 1));
+    my_deque<int> g;
+    try {
+        g.deserialize(cut);
+        ASSERT_TRUE(false);
+    } catch (std::runtime_error&) {
+        ASSERT_LT(g.size(), 10);
+    }
+}
+
+// -------------
+// TestDequeCost
+// -------------
+
+/**
+ * Upper bounds on what each operation costs in allocations and in element constructions,
+ * copies and moves, checked at growing sizes so that an operation that turns O(n) where
+ * it should be O(1) fails here instead of only in a benchmark.
+ */
+template <typename D>
+struct TestDequeCost : testing::Test {
+    typedef D deque_type;
+
+    void SetUp () {
+        allocation_stats::reset();
+        element_stats::reset();
+    }
+
+    /**
+     * start counting from here
+     */
+    static void reset () {
+        allocation_stats::reset();
+        element_stats::reset();
+    }
+
+    /**
+     * @return  the most bytes a container of n tracked values should have asked for in total
+     */
+    static size_t byte_budget (size_t n) {
+        return 3 * n * sizeof(tracked) + 4096;
+    }
+
+    /**
+     * @return  the most allocations a container of n tracked values should have made
+     */
+    static size_t allocation_budget (size_t n) {
+        return n / INITIAL_ROW_SIZE + 64;
+    }
+};
+
+typedef testing::Types<
+            std::deque<tracked, counting_allocator<tracked> >,
+            my_deque<tracked, counting_allocator<tracked> > >
+        cost_types;
+
+TYPED_TEST_CASE(TestDequeCost, cost_types);
+
+const size_t cost_sizes[] = {1000, 10000, 100000};
+
+TYPED_TEST(TestDequeCost, push_back_1) {
+    typedef typename TestFixture::deque_type deque_type;
+    for(size_t k = 0; k < 3; ++k) {
+        const size_t n = cost_sizes[k];
+        TestFixture::reset();
+        {
+            deque_type x;
+            const tracked v(1);
+            for(size_t i = 0; i < n; ++i)
+                x.push_back(v);
+            ASSERT_LE(allocation_stats::get().allocations, TestFixture::allocation_budget(n));
+            ASSERT_LE(allocation_stats::get().bytes, TestFixture::byte_budget(n));
+            ASSERT_EQ(element_stats::get().copies, n);
+            ASSERT_EQ(element_stats::get().moves, 0);
+        }
+        ASSERT_EQ(allocation_stats::get().live, 0);
+    }
+}
+
+TYPED_TEST(TestDequeCost, push_front_1) {
+    typedef typename TestFixture::deque_type deque_type;
+    for(size_t k = 0; k < 3; ++k) {
+        const size_t n = cost_sizes[k];
+        TestFixture::reset();
+        deque_type x;
+        const tracked v(1);
+        for(size_t i = 0; i < n; ++i)
+            x.push_front(v);
+        ASSERT_LE(allocation_stats::get().allocations, TestFixture::allocation_budget(n));
+        ASSERT_LE(allocation_stats::get().bytes, TestFixture::byte_budget(n));
+        ASSERT_EQ(element_stats::get().copies, n);
+        ASSERT_EQ(element_stats::get().moves, 0);
+    }
+}
+
+TYPED_TEST(TestDequeCost, pop_1) {
+    typedef typename TestFixture::deque_type deque_type;
+    for(size_t k = 0; k < 3; ++k) {
+        const size_t n = cost_sizes[k];
+        deque_type x(n, tracked(2));
+        TestFixture::reset();
+        for(size_t i = 0; i < n / 2; ++i)
+            x.pop_back();
+        while(!x.empty())
+            x.pop_front();
+        ASSERT_EQ(allocation_stats::get().allocations, 0);
+        ASSERT_EQ(element_stats::touched(), 0);
+        ASSERT_EQ(element_stats::get().destructions, n);
+    }
+}
+
+TYPED_TEST(TestDequeCost, read_1) {
+    typedef typename TestFixture::deque_type deque_type;
+    for(size_t k = 0; k < 3; ++k) {
+        const size_t n = cost_sizes[k];
+        deque_type x(n, tracked(3));
+        TestFixture::reset();
+        int s = 0;
+        for(size_t i = 0; i < n; ++i)
+            s += x[i].value + x.at(i).value;
+        for(typename deque_type::iterator it = x.begin(); it != x.end(); ++it)
+            s += it->value;
+        ASSERT_EQ(s, 9 * (int)n);
+        ASSERT_EQ(allocation_stats::get().allocations, 0);
+        ASSERT_EQ(element_stats::touched(), 0);
+    }
+}
+
+TYPED_TEST(TestDequeCost, copy_1) {
+    typedef typename TestFixture::deque_type deque_type;
+    for(size_t k = 0; k < 3; ++k) {
+        const size_t n = cost_sizes[k];
+        deque_type x(n, tracked(4));
+        TestFixture::reset();
+        deque_type y(x);
+        ASSERT_LE(allocation_stats::get().allocations, TestFixture::allocation_budget(n));
+        ASSERT_LE(allocation_stats::get().bytes, TestFixture::byte_budget(n));
+        ASSERT_EQ(element_stats::touched(), n);
+    }
+}
+
+TYPED_TEST(TestDequeCost, insert_1) {
+    typedef typename TestFixture::deque_type deque_type;
+    for(size_t k = 0; k < 3; ++k) {
+        const size_t n = cost_sizes[k];
+        deque_type x(n, tracked(5));
+        const tracked v(6);
+        TestFixture::reset();
+        x.insert(x.begin() + n / 2, v);
+        ASSERT_LE(allocation_stats::get().allocations, 2);
+        ASSERT_LE(element_stats::touched(), n + 2);
+        ASSERT_EQ(x[n / 2].value, 6);
+    }
+}
+
+TYPED_TEST(TestDequeCost, resize_1) {
+    typedef typename TestFixture::deque_type deque_type;
+    for(size_t k = 0; k < 3; ++k) {
+        const size_t n = cost_sizes[k];
+        deque_type x;
+        TestFixture::reset();
+        x.resize(n, tracked(7));
+        ASSERT_LE(allocation_stats::get().allocations, TestFixture::allocation_budget(n));
+        ASSERT_LE(allocation_stats::get().bytes, TestFixture::byte_budget(n));
+        ASSERT_LE(element_stats::touched(), n + 1);
+    }
+}
+
+// ---------------
+// TestStaticDeque
+// ---------------
+
+TEST(TestStaticDeque, capacity_1) {
+    static_assert(static_deque<int, 5>::capacity() == 5, "capacity is a constant expression");
+    int a[static_deque<int, 5>::max_size()] = {};
+    static_deque<int, 5> x;
+    ASSERT_EQ(sizeof(a) / sizeof(a[0]), x.capacity());
+    ASSERT_TRUE(x.empty());
+}
+
+TEST(TestStaticDeque, full_1) {
+    static_deque<int, 4> x(4, 1);
+    ASSERT_THROW(x.push_back(2), std::length_error);
+    ASSERT_THROW(x.push_front(2), std::length_error);
+    ASSERT_THROW(x.insert(x.begin() + 2, 2), std::length_error);
+    ASSERT_THROW(x.resize(5), std::length_error);
+    ASSERT_THROW((static_deque<int, 4>(5)), std::length_error);
+    ASSERT_EQ(x.size(), 4);
+    ASSERT_EQ(x, (static_deque<int, 4>(4, 1)));
+}
+
+TEST(TestStaticDeque, wrap_1) {
+    static_deque<int, 4> x;
+    for(int i = 0; i < 10; ++i) {
+        x.push_back(i);
+        if(x.size() == 3)
+            x.pop_front();
+    }
+    ASSERT_EQ(x.size(), 2);
+    ASSERT_EQ(x.front(), 8);
+    ASSERT_EQ(x.back(), 9);
+    x.push_front(7);
+    x.push_front(6);
+    ASSERT_EQ(x.at(0), 6);
+    ASSERT_EQ(x.at(3), 9);
+    ASSERT_THROW(x.at(4), std::out_of_range);
+}
+
+TEST(TestStaticDeque, insert_1) {
+    static_deque<int, 8> x;
+    for(int i = 0; i < 6; ++i)
+        x.push_back(i);
+    x.pop_front();
+    x.push_back(6);
+    ASSERT_EQ(*x.insert(x.begin() + 1, x[4]), 5);
+    ASSERT_EQ(*x.insert(x.begin() + 5, x[0]), 1);
+    int a[] = {1, 5, 2, 3, 4, 1, 5, 6};
+    ASSERT_TRUE(std::equal(x.begin(), x.end(), a));
+    ASSERT_EQ(*x.erase(x.begin() + 1), 2);
+    ASSERT_EQ(*x.erase(x.begin() + 5), 6);
+    int b[] = {1, 2, 3, 4, 1, 6};
+    ASSERT_TRUE(std::equal(x.begin(), x.end(), b));
+}
+
+TEST(TestStaticDeque, string_1) {
+    static_deque<std::string, 3> x;
+    x.push_back("b");
+    x.push_front("a");
+    static_deque<std::string, 3> y(x);
+    y.push_back("c");
+    x.swap(y);
+    ASSERT_EQ(x.size(), 3);
+    ASSERT_EQ(x.back(), "c");
+    ASSERT_EQ(y.size(), 2);
+    ASSERT_TRUE(y < x);
+    y = x;
+    ASSERT_EQ(y, x);
+}
+
+TEST(TestStaticDeque, mixed_1) {
+    static_deque<int, 64> d;
+    std::deque<int> x;
+    unsigned r = 38;
+    for(int i = 0; i < 20000; ++i) {
+        r = r * 1103515245 + 12345;
+        size_t p = (r >> 4) % (x.size() + 1);
+        unsigned op = (r >> 28) % 5;
+        if(x.size() == 64)
+            op = 4;
+        if(op == 0) {
+            d.push_back(i);
+            x.push_back(i);
+        }
+        else if(op == 1) {
+            d.push_front(i);
+            x.push_front(i);
+        }
+        else if(op == 2) {
+            d.insert(d.begin() + p, i);
+            x.insert(x.begin() + p, i);
+        }
+        else if(op == 3 && !x.empty()) {
+            p = p % x.size();
+            d.erase(d.begin() + p);
+            x.erase(x.begin() + p);
+        }
+        else if(!x.empty()) {
+            d.pop_front();
+            x.pop_front();
+        }
+        ASSERT_EQ(d.size(), x.size());
+    }
+    ASSERT_TRUE(std::equal(x.begin(), x.end(), d.begin()));
+}
+
+// -----------------
+// TestNumaAllocator
+// -----------------
+
+TEST(TestNumaAllocator, align_1) {
+    numa_allocator<int> a;
+    int* p = a.allocate(INITIAL_ROW_SIZE);
+    int* q = a.allocate(3);
+    int* r = a.allocate(2 * ROW_PAGE_SIZE);
+    ASSERT_EQ(reinterpret_cast<size_t>(p) % CACHE_LINE_SIZE, 0);
+    ASSERT_EQ(reinterpret_cast<size_t>(q) % CACHE_LINE_SIZE, 0);
+    ASSERT_EQ(reinterpret_cast<size_t>(r) % ROW_PAGE_SIZE, 0);
+    a.deallocate(p, INITIAL_ROW_SIZE);
+    a.deallocate(q, 3);
+    a.deallocate(r, 2 * ROW_PAGE_SIZE);
+}
+
+TEST(TestNumaAllocator, reuse_1) {
+    std::shared_ptr<numa_arena> arena(new numa_arena);
+    numa_allocator<double> a(0, arena);
+    double* p = a.allocate(INITIAL_ROW_SIZE);
+    a.deallocate(p, INITIAL_ROW_SIZE);
+    ASSERT_EQ(a.allocate(INITIAL_ROW_SIZE), p);
+    a.deallocate(p, INITIAL_ROW_SIZE);
+}
+
+TEST(TestNumaAllocator, equal_1) {
+    std::shared_ptr<numa_arena> arena(new numa_arena);
+    numa_allocator<int> a(0, arena);
+    numa_allocator<int> b(NUMA_LOCAL, arena);
+    numa_allocator<char*> c(a);
+    ASSERT_TRUE(a == b);
+    ASSERT_TRUE(numa_allocator<int>(c) == a);
+    ASSERT_EQ(c.get_node(), 0);
+    ASSERT_TRUE(a != numa_allocator<int>());
+    ASSERT_THROW(numa_allocator<int>(numa_arena::node_count(), arena).allocate(1), std::invalid_argument);
+}
+
+TEST(TestNumaAllocator, deque_1) {
+    std::shared_ptr<numa_arena> arena(new numa_arena);
+    my_deque<int, numa_allocator<int> > x((numa_allocator<int>(0, arena)));
+    for(int i = 0; i < 1000; ++i) {
+        x.push_back(i);
+        x.push_front(-i);
+    }
+    //a row of 16 ints is one cache line, so the slot in the row follows from the address
+    size_t first = reinterpret_cast<size_t>(&x[0]) % CACHE_LINE_SIZE / sizeof(int);
+    for(size_t i = 0; i < x.size(); ++i)
+        ASSERT_EQ(reinterpret_cast<size_t>(&x[i]) % CACHE_LINE_SIZE / sizeof(int), (first + i) % INITIAL_ROW_SIZE);
+    ASSERT_EQ(x.front(), -999);
+    ASSERT_EQ(x.back(), 999);
+}
+
+TEST(TestNumaAllocator, threads_1) {
+    std::shared_ptr<numa_arena> arena(new numa_arena);
+    long long sums[4] = {};
+    std::vector<std::thread> v;
+    for(int t = 0; t < 4; ++t)
+        v.push_back(std::thread([&arena, &sums, t] () {
+            for(int k = 0; k < 20; ++k) {
+                my_deque<long long, numa_allocator<long long> > x((numa_allocator<long long>(NUMA_LOCAL, arena)));
+                for(int i = 0; i < 500; ++i)
+                    x.push_back(i);
+                for(int i = 0; i < 500; ++i)
+                    sums[t] += x[i];
+            }}));
+    for(int t = 0; t < 4; ++t)
+        v[t].join();
+    for(int t = 0; t < 4; ++t)
+        ASSERT_EQ(sums[t], 20 * 124750);
+}
+
+// -----------------
+// TestDequePrefetch
+// -----------------
+
+TEST(TestDequePrefetch, equal_1) {
+    my_deque<int> x;
+    my_deque<int> y;
+    for(int i = 0; i < 1000; ++i) {
+        x.push_back(i);
+        y.push_back(i);
+    }
+    for(int i = 0; i < 7; ++i)
+        y.pop_front();
+    for(int i = 6; i >= 0; --i)
+        y.push_front(i);
+    ASSERT_TRUE(x == y);
+    y[999] = 0;
+    ASSERT_FALSE(x == y);
+    y[999] = 999;
+    y[500] = 0;
+    ASSERT_FALSE(x == y);
+}
+
+TEST(TestDequePrefetch, less_1) {
+    my_deque<int> x(100, 3);
+    my_deque<int> y(100, 3);
+    y.push_front(3);
+    y.pop_back();
+    ASSERT_FALSE(x < y);
+    ASSERT_FALSE(y < x);
+    y[77] = 4;
+    ASSERT_TRUE(x < y);
+    ASSERT_FALSE(y < x);
+    y[77] = 3;
+    y.push_back(0);
+    ASSERT_TRUE(x < y);
+    x[99] = 4;
+    ASSERT_TRUE(y < x);
+}
+
+TEST(TestDequePrefetch, less_2) {
+    my_deque<double> x(40, 1.0);
+    my_deque<double> y(40, 1.0);
+    x[10] = y[10] = std::numeric_limits<double>::quiet_NaN();
+    x[30] = 2.0;
+    ASSERT_TRUE(y < x);
+    ASSERT_FALSE(x < y);
+}
+
+TEST(TestDequePrefetch, rows_1) {
+    my_deque<int> x;
+    for(int i = 0; i < 500; ++i)
+        x.push_front(i);
+    const size_t d = deque_prefetch::rows();
+    for(size_t r = 0; r < 40; r += 13) {
+        deque_prefetch::rows() = r;
+        long long s = 0;
+        for(my_deque<int>::iterator it = x.begin(); it != x.end(); ++it)
+            s += *it;
+        const my_deque<int>& c = x;
+        for(my_deque<int>::const_iterator it = c.end(); it != c.begin(); )
+            s += *--it;
+        ASSERT_EQ(s, 2 * 124750);
+        ASSERT_TRUE(x == my_deque<int>(x));
+    }
+    deque_prefetch::rows() = d;
+}
+
+// ---------------
+// TestDequeSplice
+// ---------------
+
+TEST(TestDequeSplice, append_1) {
+    my_deque<int> x;
+    my_deque<int> y;
+    for(int i = 0; i < 100; ++i)
+        x.push_back(i);
+    for(int i = 100; i < 300; ++i)
+        y.push_back(i);
+    x.append(std::move(y));
+    ASSERT_EQ(x.size(), 300);
+    ASSERT_TRUE(y.empty());
+    for(int i = 0; i < 300; ++i)
+        ASSERT_EQ(x[i], i);
+    y.push_back(300);
+    x.append(std::move(y));
+    ASSERT_EQ(x.back(), 300);
+}
+
+TEST(TestDequeSplice, append_2) {
+    typedef my_deque<tracked, counting_allocator<tracked> > deque_type;
+    deque_type x;
+    deque_type y;
+    for(int i = 0; i < 16; ++i)
+        x.push_back(i);  //x ends where y begins, halfway into a row
+    for(int i = 16; i < 10000; ++i)
+        y.push_back(i);
+    element_stats::reset();
+    allocation_stats::reset();
+    x.append(std::move(y));
+    ASSERT_LT(element_stats::touched(), INITIAL_ROW_SIZE);
+    ASSERT_LE(allocation_stats::get().allocations, 1);
+    ASSERT_EQ(x.size(), 10000);
+    for(int i = 0; i < 10000; ++i)
+        ASSERT_EQ(x[i].value, i);
+}
+
+TEST(TestDequeSplice, prepend_1) {
+    my_deque<int> x;
+    my_deque<int> y;
+    for(int i = 0; i < 37; ++i)
+        x.push_front(i);
+    for(int i = 0; i < 5; ++i)
+        y.push_back(-i);
+    x.prepend(std::move(y));
+    ASSERT_EQ(x.size(), 42);
+    ASSERT_TRUE(y.empty());
+    ASSERT_EQ(x.front(), 0);
+    ASSERT_EQ(x[4], -4);
+    ASSERT_EQ(x[5], 36);
+    ASSERT_EQ(x.back(), 0);
+}
+
+TEST(TestDequeSplice, split_at_1) {
+    typedef my_deque<tracked, counting_allocator<tracked> > deque_type;
+    deque_type x;
+    for(int i = 0; i < 10000; ++i)
+        x.push_back(i);
+    element_stats::reset();
+    deque_type y = x.split_at(4321);
+    ASSERT_LT(element_stats::touched(), INITIAL_ROW_SIZE);
+    ASSERT_EQ(x.size(), 4321);
+    ASSERT_EQ(y.size(), 10000 - 4321);
+    ASSERT_EQ(x.back().value, 4320);
+    ASSERT_EQ(y.front().value, 4321);
+    y.push_front(-1);
+    x.push_back(-2);
+    ASSERT_EQ(y[1].value, 4321);
+    ASSERT_EQ(x[4320].value, 4320);
+    x.pop_back();
+    y.pop_front();
+    x.append(std::move(y));
+    ASSERT_EQ(x.size(), 10000);
+    for(int i = 0; i < 10000; ++i)
+        ASSERT_EQ(x[i].value, i);
+}
+
+TEST(TestDequeSplice, split_at_2) {
+    my_deque<int> x(20, 1);
+    my_deque<int> y = x.split_at(20);
+    ASSERT_TRUE(y.empty());
+    ASSERT_EQ(x.size(), 20);
+    my_deque<int> z = x.split_at(0);
+    ASSERT_TRUE(x.empty());
+    ASSERT_EQ(z, my_deque<int>(20, 1));
+    x.push_back(2);
+    ASSERT_EQ(x.front(), 2);
+}
+
+TEST(TestDequeSplice, mixed_1) {
+    std::deque<int> d[3];
+    my_deque<int> x[3];
+    unsigned r = 41;
+    for(int i = 0; i < 3000; ++i) {
+        r = r * 1103515245 + 12345;
+        size_t a = (r >> 8) % 3;
+        size_t b = (r >> 12) % 3;
+        unsigned op = (r >> 28) % 5;
+        if(op < 2) {
+            d[a].push_back(i);
+            x[a].push_back(i);
+            d[b].push_front(-i);
+            x[b].push_front(-i);
+        }
+        else if((op == 2) && (a != b)) {
+            d[a].insert(d[a].end(), d[b].begin(), d[b].end());
+            d[b].clear();
+            x[a].append(std::move(x[b]));
+        }
+        else if((op == 3) && (a != b)) {
+            d[a].insert(d[a].begin(), d[b].begin(), d[b].end());
+            d[b].clear();
+            x[a].prepend(std::move(x[b]));
+        }
+        else if(a != b) {
+            size_t p = d[a].empty() ? 0 : (r >> 4) % (d[a].size() + 1);
+            d[b].assign(d[a].begin() + p, d[a].end());
+            d[a].erase(d[a].begin() + p, d[a].end());
+            x[b] = x[a].split_at(p);
+        }
+        for(size_t k = 0; k < 3; ++k)
+            ASSERT_EQ(d[k].size(), x[k].size());
+    }
+    for(size_t k = 0; k < 3; ++k)
+        ASSERT_TRUE(std::equal(d[k].begin(), d[k].end(), x[k].begin()));
+}
+
+// ---------------
+// TestSortedDeque
+// ---------------
+
+TEST(TestSortedDeque, segment_1) {
+    my_deque<int> x;
+    ASSERT_EQ(x.segment_count(), 0);
+    for(int i = 0; i < 40; ++i)
+        x.push_back(i);
+    ASSERT_EQ(x.segment_count(), 3);
+    ASSERT_EQ(x.segment(0).length, INITIAL_ROW_SIZE / 2);
+    ASSERT_EQ(x.segment(1).length, INITIAL_ROW_SIZE);
+    ASSERT_EQ(x.segment(1)[0], INITIAL_ROW_SIZE / 2);
+    ASSERT_EQ(x.segment(2).length, 40 - INITIAL_ROW_SIZE * 3 / 2);
+    ASSERT_EQ(*(x.segment(2).end() - 1), 39);
+}
+
+TEST(TestSortedDeque, bound_1) {
+    sorted_deque<int> x;
+    ASSERT_EQ(x.lower_bound(5), 0);
+    for(int i = 0; i < 100; ++i)
+        x.push_back(2 * i);
+    ASSERT_EQ(x.lower_bound(-1), 0);
+    ASSERT_EQ(x.lower_bound(0), 0);
+    ASSERT_EQ(x.upper_bound(0), 1);
+    ASSERT_EQ(x.lower_bound(15), 8);
+    ASSERT_EQ(x.lower_bound(16), 8);
+    ASSERT_EQ(x.upper_bound(16), 9);
+    ASSERT_EQ(x.lower_bound(198), 99);
+    ASSERT_EQ(x.upper_bound(198), 100);
+    ASSERT_EQ(x.lower_bound(500), 100);
+}
+
+TEST(TestSortedDeque, bound_2) {
+    sorted_deque<int> x;
+    for(int i = 0; i < 200; ++i)
+        x.push_back(i / 20);
+    for(int k = 0; k < 10; ++k) {
+        ASSERT_EQ(x.lower_bound(k), 20 * k);
+        ASSERT_EQ(x.upper_bound(k), 20 * k + 20);
+    }
+}
+
+TEST(TestSortedDeque, pop_1) {
+    sorted_deque<int> x;
+    for(int i = 0; i < 50; ++i)
+        x.push_back(i);
+    for(int i = 0; i < 23; ++i)
+        x.pop_front();
+    ASSERT_EQ(x.front(), 23);
+    ASSERT_EQ(x.lower_bound(0), 0);
+    ASSERT_EQ(x.lower_bound(23), 0);
+    ASSERT_EQ(x.lower_bound(24), 1);
+    ASSERT_EQ(x.lower_bound(49), 26);
+    while(!x.empty())
+        x.pop_front();
+    ASSERT_EQ(x.upper_bound(7), 0);
+    x.push_back(7);
+    ASSERT_EQ(x.upper_bound(7), 1);
+}
+
+TEST(TestSortedDeque, greater_1) {
+    sorted_deque<double, std::greater<double> > x;
+    for(int i = 0; i < 64; ++i)
+        x.push_back(100 - i);
+    ASSERT_EQ(x.lower_bound(90), 10);
+    ASSERT_EQ(x.upper_bound(90), 11);
+    ASSERT_EQ(x.at(10), 90);
+}
+
+TEST(TestSortedDeque, mixed_1) {
+    sorted_deque<int> x;
+    std::deque<int> d;
+    unsigned r = 42;
+    int next = 0;
+    for(int i = 0; i < 20000; ++i) {
+        r = r * 1103515245 + 12345;
+        //grow for a while, then shrink, so popped rows get compacted away
+        bool grow = ((i / 5000) & 1) ? ((r >> 28) < 5) : ((r >> 28) < 11);
+        if(grow || d.empty()) {
+            next += (r >> 8) % 3;
+            x.push_back(next);
+            d.push_back(next);
+        }
+        else {
+            x.pop_front();
+            d.pop_front();
+        }
+        int v = d.empty() ? next : d.front() - 1 + (r >> 4) % (next - d.front() + 3);
+        ASSERT_EQ(x.lower_bound(v), std::lower_bound(d.begin(), d.end(), v) - d.begin());
+        ASSERT_EQ(x.upper_bound(v), std::upper_bound(d.begin(), d.end(), v) - d.begin());
+    }
+    ASSERT_EQ(x.size(), d.size());
+    ASSERT_TRUE(std::equal(d.begin(), d.end(), x.begin()));
+}
+
+// ----------------
+// TestDequeReclaim
+// ----------------
+
+TEST(TestDequeReclaim, clear_1) {
+    deque_reclaimer r;
+    my_deque<tracked> x(10000, tracked(1));
+    x.set_reclaimer(&r);
+    ASSERT_EQ(x.get_reclaimer(), &r);
+    element_stats::reset();
+    x.clear();
+    ASSERT_TRUE(x.empty());
+    r.drain();
+    ASSERT_EQ(element_stats::get().destructions, 10000);
+    ASSERT_EQ(r.pending_rows(), 0);
+    ASSERT_GE(r.reclaimed_rows(), 10000 / INITIAL_ROW_SIZE);
+    ASSERT_EQ(r.refused_jobs(), 0);
+    x.push_back(2);
+    x.push_front(3);
+    ASSERT_EQ(x.front().value, 3);
+}
+
+TEST(TestDequeReclaim, destructor_1) {
+    deque_reclaimer r;
+    element_stats::reset();
+    {
+        my_deque<tracked> x;
+        x.set_reclaimer(&r);
+        for(int i = 0; i < 5000; ++i)
+            x.push_front(i);
+    }
+    r.drain();
+    ASSERT_EQ(element_stats::get().destructions, element_stats::touched());
+}
+
+TEST(TestDequeReclaim, pop_front_n_1) {
+    deque_reclaimer r;
+    my_deque<tracked> x;
+    x.set_reclaimer(&r);
+    for(int i = 0; i < 1000; ++i)
+        x.push_back(i);
+    element_stats::reset();
+    x.pop_front_n(3);
+    ASSERT_EQ(x.front().value, 3);
+    x.pop_front_n(500);
+    ASSERT_EQ(x.front().value, 503);
+    ASSERT_EQ(x.size(), 497);
+    for(int i = 502; i >= 0; --i)
+        x.push_front(i);
+    for(int i = 0; i < 1000; ++i)
+        ASSERT_EQ(x[i].value, i);
+    x.pop_front_n(x.size());
+    ASSERT_TRUE(x.empty());
+    r.drain();
+    ASSERT_EQ(element_stats::get().destructions, 1503 + 503); //and the temporaries pushed
+}
+
+TEST(TestDequeReclaim, pop_front_n_2) {
+    my_deque<std::string> x;
+    for(int i = 0; i < 100; ++i)
+        x.push_back(std::string(40, 'a' + i % 26));
+    x.pop_front_n(0);
+    x.pop_front_n(27);
+    ASSERT_EQ(x.size(), 73);
+    ASSERT_EQ(x.front(), std::string(40, 'b'));
+    ASSERT_EQ(x.get_reclaimer(), (reclaim_sink*)0);
+}
+
+TEST(TestDequeReclaim, bound_1) {
+    deque_reclaimer r(8);
+    my_deque<tracked> x(1000, tracked(1));
+    my_deque<tracked> y(100, tracked(2));
+    x.set_reclaimer(&r);
+    y.set_reclaimer(&r);
+    element_stats::reset();
+    x.clear();  //too many rows for the bound, so destroyed right here
+    ASSERT_EQ(element_stats::get().destructions, 1000);
+    ASSERT_EQ(r.refused_jobs(), 1);
+    y.clear();
+    r.drain();
+    ASSERT_EQ(element_stats::get().destructions, 1100);
+    ASSERT_EQ(r.max_rows(), 8);
+}
+
+TEST(TestDequeReclaim, threads_1) {
+    deque_reclaimer r(64);
+    std::vector<std::thread> v;
+    for(int t = 0; t < 4; ++t)
+        v.push_back(std::thread([&r] () {
+            for(int k = 0; k < 50; ++k) {
+                my_deque<std::string> x;
+                x.set_reclaimer(&r);
+                for(int i = 0; i < 300; ++i)
+                    x.push_back(std::string(30, 'x'));
+                x.pop_front_n(100);
+                ASSERT_EQ(x.size(), 200);
+            }}));
+    for(int t = 0; t < 4; ++t)
+        v[t].join();
+    r.drain();
+    ASSERT_EQ(r.pending_rows(), 0);
+}
+
+// --------------
+// TestDequeTrace
+// --------------
+
+TEST(TestDequeTrace, round_trip_1) {
+    std::ostringstream out;
+    {
+        trace_writer w(out);
+        w.record(TRACE_PUSH_BACK, 0, 5);
+        w.record(TRACE_PUSH_FRONT, 0, -7);
+        w.record(TRACE_INDEX, 1);
+        w.record(TRACE_INSERT, 1ULL << 40, std::numeric_limits<long long>::min());
+        w.record(TRACE_ERASE, 127);
+        w.record(TRACE_POP_BACK);
+        w.record(TRACE_POP_FRONT);
+        w.record(TRACE_CLEAR);
+    }
+    std::istringstream in(out.str());
+    std::vector<trace_op> v = read_trace(in);
+    ASSERT_EQ(v.size(), 8);
+    ASSERT_EQ(v[0].code, TRACE_PUSH_BACK);
+    ASSERT_EQ(v[0].value, 5);
+    ASSERT_EQ(v[1].value, -7);
+    ASSERT_EQ(v[2].code, TRACE_INDEX);
+    ASSERT_EQ(v[2].index, 1);
+    ASSERT_EQ(v[3].index, 1ULL << 40);
+    ASSERT_EQ(v[3].value, std::numeric_limits<long long>::min());
+    ASSERT_EQ(v[4].index, 127);
+    ASSERT_EQ(v[4].value, 0);
+    ASSERT_EQ(v[5].code, TRACE_POP_BACK);
+    ASSERT_EQ(v[6].code, TRACE_POP_FRONT);
+    ASSERT_EQ(v[7].code, TRACE_CLEAR);
+}
+
+TEST(TestDequeTrace, round_trip_2) {
+    std::ostringstream out;
+    {
+        trace_writer w(out);
+        for(int i = 0; i < 100000; ++i)   //past one buffer
+            w.record(TRACE_PUSH_BACK, 0, std::numeric_limits<long long>::max() - i);
+    }
+    std::istringstream in(out.str());
+    std::vector<trace_op> v = read_trace(in);
+    ASSERT_EQ(v.size(), 100000);
+    ASSERT_EQ(v[99999].value, std::numeric_limits<long long>::max() - 99999);
+}
+
+TEST(TestDequeTrace, recording_1) {
+    std::ostringstream out;
+    {
+        trace_writer w(out);
+        recording_deque<int> x(w);
+        x.push_back(1);
+        x.push_back(3);
+        x.push_front(0);
+        x.insert(x.begin() + 2, 2);
+        ASSERT_EQ(x[2], 2);
+        x.erase(x.begin());
+        x.pop_back();
+        ASSERT_EQ(x.size(), 2);
+        ASSERT_EQ(x.deque().front(), 1);
+        ASSERT_EQ(x.deque().back(), 2);
+    }
+    std::istringstream in(out.str());
+    std::vector<trace_op> v = read_trace(in);
+    ASSERT_EQ(v.size(), 7);
+    ASSERT_EQ(v[3].code, TRACE_INSERT);
+    ASSERT_EQ(v[3].index, 2);
+    ASSERT_EQ(v[3].value, 2);
+    ASSERT_EQ(v[4].code, TRACE_INDEX);
+    ASSERT_EQ(v[5].code, TRACE_ERASE);
+    ASSERT_EQ(v[5].index, 0);
+}
+
+TEST(TestDequeTrace, recording_2) {
+    std::ostringstream out;
+    {
+        trace_writer w(out);
+        recording_deque<std::string> x(w);
+        x.push_back("abc");
+        x.push_front("x");
+        x.clear();
+        ASSERT_TRUE(x.deque().empty());
+    }
+    std::istringstream in(out.str());
+    std::vector<trace_op> v = read_trace(in);
+    ASSERT_EQ(v.size(), 3);
+    ASSERT_EQ(v[0].value, 0);
+    ASSERT_EQ(v[2].code, TRACE_CLEAR);
+}
+
+TEST(TestDequeTrace, read_1) {
+    std::istringstream in("MYDX\1\0\0\0");
+    ASSERT_THROW(read_trace(in), std::runtime_error);
+    std::istringstream empty("");
+    ASSERT_THROW(read_trace(empty), std::runtime_error);
+}
+
+TEST(TestDequeTrace, read_2) {
+    std::ostringstream out;
+    {
+        trace_writer w(out);
+        w.record(TRACE_INSERT, 1000, 1000);
+    }
+    std::string s = out.str();
+    std::istringstream cut(s.substr(0, s.size() - 1));
+    ASSERT_THROW(read_trace(cut), std::runtime_error);
+    s[TRACE_HEADER] = 99;
+    std::istringstream bad(s);
+    ASSERT_THROW(read_trace(bad), std::runtime_error);
+}
+
+TEST(TestDequeTrace, mixed_1) {
+    std::ostringstream out;
+    my_deque<long long> y;
+    {
+        trace_writer w(out);
+        recording_deque<long long> x(w);
+        unsigned r = 7;
+        for(int i = 0; i < 5000; ++i) {
+            r = r * 1103515245 + 12345;
+            unsigned c = (r >> 16) % 10;
+            if(x.size() && (c == 0))
+                x.insert(x.begin() + (r >> 4) % x.size(), -i);
+            else if(x.size() && (c == 1))
+                x.erase(x.begin() + (r >> 4) % x.size());
+            else if(x.size() && (c == 2))
+                x[(r >> 4) % x.size()];
+            else if(x.size() && (c == 3))
+                x.pop_front();
+            else if(x.size() && (c == 4))
+                x.pop_back();
+            else if(c < 8)
+                x.push_back(i);
+            else
+                x.push_front(i);
+        }
+        y = x.deque();
+    }
+    std::istringstream in(out.str());
+    std::vector<trace_op> v = read_trace(in);
+    my_deque<long long> a;
+    std::deque<long long> b;
+    long long sa = 0;
+    long long sb = 0;
+    for(size_t i = 0; i < v.size(); ++i) {
+        sa += trace_apply(a, v[i]);
+        sb += trace_apply(b, v[i]);
+    }
+    ASSERT_EQ(sa, sb);
+    ASSERT_TRUE(a == y);
+    ASSERT_EQ(b.size(), y.size());
+    ASSERT_TRUE(std::equal(b.begin(), b.end(), y.begin()));
+}
+
+// -------------
+// TestDequeSort
+// -------------
+
+TEST(TestDequeSort, sort_1) {
+    my_deque<int> x;
+    x.sort();
+    ASSERT_TRUE(x.empty());
+    x.push_back(3);
+    x.stable_sort();
+    ASSERT_EQ(x.size(), 1);
+    ASSERT_EQ(x.front(), 3);
+}
+
+TEST(TestDequeSort, sort_2) {
+    my_deque<int> x;
+    for(int i = 0; i < 100; ++i)
+        x.push_back((i * 37) % 101);
+    x.sort();
+    for(int i = 1; i < 100; ++i)
+        ASSERT_TRUE(x[i - 1] < x[i]);
+}
+
+TEST(TestDequeSort, sort_3) {
+    my_deque<int> x;
+    unsigned r = 3;
+    for(int i = 0; i < 600000; ++i) { //three runs of ints, the first starting mid row
+        r = r * 1103515245 + 12345;
+        if(i % 3)
+            x.push_back(r >> 8);
+        else
+            x.push_front(r >> 8);
+    }
+    x.pop_front();
+    std::vector<int> y(x.begin(), x.end());
+    std::sort(y.begin(), y.end());
+    my_deque<int> z(x);
+    x.sort();
+    ASSERT_EQ(x.size(), 599999);
+    ASSERT_TRUE(std::equal(y.begin(), y.end(), x.begin()));
+    z.stable_sort();
+    ASSERT_TRUE(x == z);
+}
+
+TEST(TestDequeSort, sort_4) {
+    my_deque<std::string> x;
+    for(int i = 0; i < 100000; ++i) //about three runs of strings
+        x.push_back(std::string(1 + i % 7, 'a' + (i * 11) % 26));
+    std::vector<std::string> y(x.begin(), x.end());
+    std::sort(y.begin(), y.end(), std::greater<std::string>());
+    x.sort(std::greater<std::string>());
+    ASSERT_TRUE(std::equal(y.begin(), y.end(), x.begin()));
+}
+
+TEST(TestDequeSort, stable_sort_1) {
+    my_deque< std::pair<int, int> > x;
+    for(int i = 0; i < 400000; ++i) //about three runs of pairs
+        x.push_back(std::make_pair((i * 7) % 13, i));
+    x.stable_sort([] (const std::pair<int, int>& a, const std::pair<int, int>& b) {
+        return a.first < b.first;});
+    for(size_t i = 1; i < x.size(); ++i) {
+        ASSERT_TRUE(x[i - 1].first <= x[i].first);
+        if(x[i - 1].first == x[i].first)
+            ASSERT_TRUE(x[i - 1].second < x[i].second);
+    }
+}
+
+TEST(TestDequeSort, allocations_1) {
+    my_deque<int, counting_allocator<int> > x;
+    for(int i = 0; i < 600000; ++i)
+        x.push_front(i);
+    allocation_stats::reset();
+    const size_t live = allocation_stats::get().live;
+    x.sort();
+    ASSERT_EQ(x.front(), 0);
+    ASSERT_EQ(x.back(), 599999);
+    ASSERT_EQ(allocation_stats::get().live, live);
+    ASSERT_TRUE(allocation_stats::get().peak - live < SORT_RUN_BYTES + 64 * INITIAL_ROW_SIZE * sizeof(int));
+}
+
+TEST(TestDequeSort, mixed_1) {
+    unsigned r = 11;
+    for(int t = 0; t < 10; ++t) {
+        my_deque<double> x;
+        r = r * 1103515245 + 12345;
+        int n = (r >> 8) % 500000;
+        for(int i = 0; i < n; ++i) {
+            r = r * 1103515245 + 12345;
+            if((r >> 4) & 1)
+                x.push_back((r >> 12) % 1000);
+            else
+                x.push_front((r >> 12) % 1000);
+        }
+        std::vector<double> y(x.begin(), x.end());
+        std::sort(y.begin(), y.end());
+        if(t & 1)
+            x.stable_sort();
+        else
+            x.sort();
+        ASSERT_EQ(x.size(), y.size());
+        ASSERT_TRUE(std::equal(y.begin(), y.end(), x.begin()));
+    }
+}
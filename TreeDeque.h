@@ -0,0 +1,925 @@
+// --------------------------
+// projects/deque/TreeDeque.h
+// Copyright (C) 2014
+// Taylor Gregston
+// --------------------------
+
+#ifndef TreeDeque_h
+#define TreeDeque_h
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // copy, copy_backward, min
+#include <cassert>   // assert
+#include <cstddef>   // size_t
+#include <iterator>  // bidirectional_iterator_tag
+#include <memory>    // allocator
+#include <stdexcept> // out_of_range
+#include <utility>   // forward, move, swap
+
+#include "Deque.h"
+
+// -------
+// defines
+// -------
+
+/**
+ * The leaves of a tree_deque are rows of TREE_ROW_SIZE elements that may be partly full.
+ * Interior nodes have up to TREE_FANOUT children and keep the element count of each child,
+ * so an index is found by subtracting counts on the way down.
+ */
+
+#define TREE_ROW_SIZE       64  // elements per leaf row
+#define TREE_FANOUT         16  // children per interior node
+
+// ----------
+// tree_deque
+// ----------
+
+/**
+ * An indexed sequence with O(log n) operator[], insert and erase anywhere.
+ * Elements live in rows like my_deque, but the rows hang off a counted B-tree instead of
+ * the flat deque_root array, so inserting in the middle shifts at most one row.
+ * Leaves are linked so iteration is a straight walk over rows.
+ * Every node other than the root is kept at least half full.
+ */
+template < typename T, typename A = std::allocator<T> >
+class tree_deque {
+public:
+    // --------
+    // typedefs
+    // --------
+
+    typedef A                                        allocator_type;
+    typedef typename allocator_type::value_type      value_type;
+
+    typedef typename allocator_type::size_type       size_type;
+    typedef typename allocator_type::difference_type difference_type;
+
+    typedef typename allocator_type::pointer         pointer;
+    typedef typename allocator_type::const_pointer   const_pointer;
+
+    typedef typename allocator_type::reference       reference;
+    typedef typename allocator_type::const_reference const_reference;
+
+public:
+    // -----------
+    // operator ==
+    // -----------
+
+    /**
+     * checks to see if the lhs == rhs
+     * @param   lhs the left hand side in question
+     * @param   rhs the right hand side in question
+     * @return  true if the lhs and rhs have same value and number of items
+     */
+    friend bool operator == (const tree_deque& lhs, const tree_deque& rhs) {
+        return (lhs.size() == rhs.size()) && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+    }
+
+    // ----------
+    // operator <
+    // ----------
+
+    /**
+     * checks to see if the lhs < rhs
+     * @param   lhs the left hand side in question
+     * @param   rhs the right hand side in question
+     * @return  true if the lhs is less than the rhs
+     */
+    friend bool operator < (const tree_deque& lhs, const tree_deque& rhs) {
+        return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+
+private:
+    // -----
+    // nodes
+    // -----
+
+    struct tree_node {
+        size_t count;   //elements in a leaf, children in an interior node
+    };
+
+    struct tree_leaf : tree_node {
+        tree_leaf* prev; //leaf to the left, 0 for the first
+        tree_leaf* next; //leaf to the right, 0 for the last
+        T*         data; //TREE_ROW_SIZE slots, the first count constructed
+    };
+
+    struct tree_inner : tree_node {
+        size_t     sizes[TREE_FANOUT]; //elements under each child
+        tree_node* child[TREE_FANOUT];
+    };
+
+    // ----
+    // data
+    // ----
+
+    allocator_type _a;  //the element allocator
+    typename A::template rebind<tree_leaf>::other  _al; //the leaf allocator
+    typename A::template rebind<tree_inner>::other _ai; //the interior node allocator
+    tree_node* root;    //a leaf when height is 0
+    size_t height;      //interior levels above the leaves
+    size_t tree_size;   //how many elements in here
+    tree_leaf* head;    //first leaf
+    tree_leaf* tail;    //last leaf
+
+private:
+    // -----
+    // valid
+    // -----
+
+    bool valid () const {
+        return root && head && tail && !head->prev && !tail->next && (tree_size == node_size(root, height));
+    }
+
+    // ----------
+    // row shifts
+    // ----------
+
+    /**
+     * open a gap of k slots at i in a row holding count elements, count + k <= TREE_ROW_SIZE.
+     * slots of the gap below count are left constructed, the rest raw
+     */
+    void row_open (T* d, size_t count, size_t i, size_t k) {
+        for(size_t j = count; j-- > i; ) {
+            if(j + k >= count)
+                _a.construct(&d[j + k], std::move(d[j]));
+            else
+                d[j + k] = std::move(d[j]);
+        }
+    }
+
+    /**
+     * fill slot j of a gap made by row_open
+     */
+    template <typename U>
+    void row_put (T* d, size_t j, size_t count, U&& v) {
+        if(j < count)
+            d[j] = std::forward<U>(v);
+        else
+            _a.construct(&d[j], std::forward<U>(v));
+    }
+
+    /**
+     * remove k elements at i from a row holding count elements
+     */
+    void row_close (T* d, size_t count, size_t i, size_t k) {
+        for(size_t j = i; j + k < count; ++j)
+            d[j] = std::move(d[j + k]);
+        for(size_t j = count - k; j < count; ++j)
+            _a.destroy(&d[j]);
+    }
+
+    // -----
+    // nodes
+    // -----
+
+    tree_leaf* make_leaf () {
+        tree_leaf* l = _al.allocate(1);
+        try {
+            l->data = _a.allocate(TREE_ROW_SIZE);
+        }
+        catch (...) {
+            _al.deallocate(l, 1);
+            throw;}
+        l->count = 0;
+        l->prev = NULL;
+        l->next = NULL;
+        return l;
+    }
+
+    void free_leaf (tree_leaf* l) {
+        destroy(_a, l->data, l->data + l->count);
+        _a.deallocate(l->data, TREE_ROW_SIZE);
+        _al.deallocate(l, 1);
+    }
+
+    tree_inner* make_inner () {
+        tree_inner* n = _ai.allocate(1);
+        n->count = 0;
+        return n;
+    }
+
+    /**
+     * free n and everything under it
+     */
+    void free_node (tree_node* n, size_t h) {
+        if(!h) {
+            free_leaf(static_cast<tree_leaf*>(n));
+            return;
+        }
+        tree_inner* in = static_cast<tree_inner*>(n);
+        for(size_t c = 0; c < in->count; ++c)
+            free_node(in->child[c], h - 1);
+        _ai.deallocate(in, 1);
+    }
+
+    /**
+     * @return  the number of elements under n, n at height h
+     */
+    static size_t node_size (const tree_node* n, size_t h) {
+        if(!h)
+            return n->count;
+        const tree_inner* in = static_cast<const tree_inner*>(n);
+        size_t s = 0;
+        for(size_t c = 0; c < in->count; ++c)
+            s += in->sizes[c];
+        return s;
+    }
+
+    /**
+     * walk down to the leaf holding element i
+     * @param   i the index, set to the offset inside the leaf
+     * @return  the leaf
+     */
+    tree_leaf* find_leaf (size_t& i) const {
+        tree_node* n = root;
+        for(size_t h = height; h; --h) {
+            const tree_inner* in = static_cast<const tree_inner*>(n);
+            size_t c = 0;
+            while(i >= in->sizes[c]) {
+                i -= in->sizes[c];
+                ++c;
+            }
+            n = in->child[c];
+        }
+        return static_cast<tree_leaf*>(n);
+    }
+
+    /**
+     * put a child into an interior node that has room
+     */
+    static void inner_put (tree_inner* in, size_t c, tree_node* n, size_t s) {
+        std::copy_backward(in->child + c, in->child + in->count, in->child + in->count + 1);
+        std::copy_backward(in->sizes + c, in->sizes + in->count, in->sizes + in->count + 1);
+        in->child[c] = n;
+        in->sizes[c] = s;
+        ++in->count;
+    }
+
+    /**
+     * take a child out of an interior node
+     */
+    static void inner_take (tree_inner* in, size_t c) {
+        std::copy(in->child + c + 1, in->child + in->count, in->child + c);
+        std::copy(in->sizes + c + 1, in->sizes + in->count, in->sizes + c);
+        --in->count;
+    }
+
+    // ------
+    // insert
+    // ------
+
+    /**
+     * insert v at i in leaf l, splitting l if it is full
+     * @return  the new right half, or 0 if l did not split
+     */
+    tree_leaf* leaf_insert (tree_leaf* l, size_t i, const_reference v) {
+        tree_leaf* r = NULL;
+        if(l->count == TREE_ROW_SIZE) {
+            r = make_leaf();
+            const size_t half = TREE_ROW_SIZE >> 1;
+            for(size_t j = half; j < TREE_ROW_SIZE; ++j)
+                _a.construct(&r->data[j - half], std::move(l->data[j]));
+            destroy(_a, l->data + half, l->data + TREE_ROW_SIZE);
+            r->count = TREE_ROW_SIZE - half;
+            l->count = half;
+
+            r->prev = l;
+            r->next = l->next;
+            if(l->next)
+                l->next->prev = r;
+            else
+                tail = r;
+            l->next = r;
+
+            if(i > half) {
+                i -= half;
+                l = r;
+            }
+        }
+        row_open(l->data, l->count, i, 1);
+        row_put(l->data, i, l->count, v);
+        ++l->count;
+        return r;
+    }
+
+    /**
+     * insert v at i under n, n at height h
+     * @return  a new right sibling of n if n split, otherwise 0
+     */
+    tree_node* insert_at (tree_node* n, size_t h, size_t i, const_reference v) {
+        if(!h)
+            return leaf_insert(static_cast<tree_leaf*>(n), i, v);
+
+        tree_inner* in = static_cast<tree_inner*>(n);
+        size_t c = 0;
+        while((c + 1 < in->count) && (i > in->sizes[c])) {
+            i -= in->sizes[c];
+            ++c;
+        }
+        tree_node* split = insert_at(in->child[c], h - 1, i, v);
+        ++in->sizes[c];
+        if(!split)
+            return NULL;
+
+        size_t moved = node_size(split, h - 1);
+        in->sizes[c] -= moved;
+        if(in->count < TREE_FANOUT) {
+            inner_put(in, c + 1, split, moved);
+            return NULL;
+        }
+
+        tree_inner* r = make_inner();
+        const size_t half = TREE_FANOUT >> 1;
+        std::copy(in->child + half, in->child + TREE_FANOUT, r->child);
+        std::copy(in->sizes + half, in->sizes + TREE_FANOUT, r->sizes);
+        r->count = TREE_FANOUT - half;
+        in->count = half;
+        if(c + 1 > half)
+            inner_put(r, c + 1 - half, split, moved);
+        else
+            inner_put(in, c + 1, split, moved);
+        return r;
+    }
+
+    // -----
+    // erase
+    // -----
+
+    /**
+     * merge or even out child c of in and its neighbour after c fell below half full
+     */
+    void fix_child (tree_inner* in, size_t c, size_t h) {
+        if(in->count < 2)
+            return;
+        size_t a = (c + 1 < in->count) ? c : c - 1;
+        tree_node* ln = in->child[a];
+        tree_node* rn = in->child[a + 1];
+        size_t cap = h ? TREE_FANOUT : TREE_ROW_SIZE;
+        size_t total = ln->count + rn->count;
+
+        if(!h) {
+            tree_leaf* l = static_cast<tree_leaf*>(ln);
+            tree_leaf* r = static_cast<tree_leaf*>(rn);
+            if(total <= cap) {
+                for(size_t j = 0; j < r->count; ++j)
+                    _a.construct(&l->data[l->count + j], std::move(r->data[j]));
+                l->count = total;
+                l->next = r->next;
+                if(r->next)
+                    r->next->prev = l;
+                else
+                    tail = l;
+                free_leaf(r);
+            }
+            else if(l->count < total / 2) {
+                size_t k = total / 2 - l->count;
+                for(size_t j = 0; j < k; ++j)
+                    _a.construct(&l->data[l->count + j], std::move(r->data[j]));
+                row_close(r->data, r->count, 0, k);
+                l->count += k;
+                r->count -= k;
+            }
+            else {
+                size_t k = l->count - total / 2;
+                row_open(r->data, r->count, 0, k);
+                for(size_t j = 0; j < k; ++j)
+                    row_put(r->data, j, r->count, std::move(l->data[l->count - k + j]));
+                destroy(_a, l->data + l->count - k, l->data + l->count);
+                l->count -= k;
+                r->count += k;
+            }
+        }
+        else {
+            tree_inner* l = static_cast<tree_inner*>(ln);
+            tree_inner* r = static_cast<tree_inner*>(rn);
+            if(total <= cap) {
+                std::copy(r->child, r->child + r->count, l->child + l->count);
+                std::copy(r->sizes, r->sizes + r->count, l->sizes + l->count);
+                l->count = total;
+                _ai.deallocate(r, 1);
+            }
+            else if(l->count < total / 2) {
+                size_t k = total / 2 - l->count;
+                std::copy(r->child, r->child + k, l->child + l->count);
+                std::copy(r->sizes, r->sizes + k, l->sizes + l->count);
+                std::copy(r->child + k, r->child + r->count, r->child);
+                std::copy(r->sizes + k, r->sizes + r->count, r->sizes);
+                l->count += k;
+                r->count -= k;
+            }
+            else {
+                size_t k = l->count - total / 2;
+                std::copy_backward(r->child, r->child + r->count, r->child + r->count + k);
+                std::copy_backward(r->sizes, r->sizes + r->count, r->sizes + r->count + k);
+                std::copy(l->child + l->count - k, l->child + l->count, r->child);
+                std::copy(l->sizes + l->count - k, l->sizes + l->count, r->sizes);
+                l->count -= k;
+                r->count += k;
+            }
+        }
+
+        if(total <= cap) {
+            in->sizes[a] += in->sizes[a + 1];
+            inner_take(in, a + 1);
+        }
+        else {
+            in->sizes[a] = node_size(ln, h);
+            in->sizes[a + 1] = node_size(rn, h);
+        }
+    }
+
+    /**
+     * erase element i under n, n at height h
+     */
+    void erase_at (tree_node* n, size_t h, size_t i) {
+        if(!h) {
+            tree_leaf* l = static_cast<tree_leaf*>(n);
+            row_close(l->data, l->count, i, 1);
+            --l->count;
+            return;
+        }
+        tree_inner* in = static_cast<tree_inner*>(n);
+        size_t c = 0;
+        while(i >= in->sizes[c]) {
+            i -= in->sizes[c];
+            ++c;
+        }
+        erase_at(in->child[c], h - 1, i);
+        --in->sizes[c];
+        if(in->child[c]->count < ((h - 1 ? TREE_FANOUT : TREE_ROW_SIZE) >> 1))
+            fix_child(in, c, h - 1);
+    }
+
+public:
+    // --------
+    // iterator
+    // --------
+
+    template <typename P, typename R>
+    class basic_iterator {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef std::bidirectional_iterator_tag      iterator_category;
+        typedef typename tree_deque::value_type      value_type;
+        typedef typename tree_deque::difference_type difference_type;
+        typedef P                                    pointer;
+        typedef R                                    reference;
+
+    public:
+        /**
+         * checks to see if the lhs == rhs
+         * @param   lhs the left hand side in question
+         * @param   rhs the right hand side in question
+         * @return  true if the lhs and rhs point to the same value
+         */
+        friend bool operator == (const basic_iterator& lhs, const basic_iterator& rhs) {
+            return (lhs.leaf == rhs.leaf) && (lhs.offset == rhs.offset);
+        }
+
+        /**
+         * checks to see if the lhs != rhs
+         * @param   lhs the left hand side in question
+         * @param   rhs the right hand side in question
+         * @return  false if the lhs and rhs point to the same value
+         */
+        friend bool operator != (const basic_iterator& lhs, const basic_iterator& rhs) {
+            return !(lhs == rhs);
+        }
+
+    private:
+        // ----
+        // data
+        // ----
+
+        const tree_deque* owner;
+        tree_leaf* leaf;    //0 past the end
+        size_t offset;
+
+    public:
+        /**
+         * creates an iterator at offset_ of leaf_, moving on past empty leaves
+         * @param   owner_ the underlying container
+         * @param   leaf_ the leaf, 0 for end
+         * @param   offset_ the slot inside the leaf
+         */
+        basic_iterator (const tree_deque* owner_, tree_leaf* leaf_, size_t offset_) :
+        owner(owner_), leaf(leaf_), offset(offset_)
+        {
+            while(leaf && offset == leaf->count) {
+                leaf = leaf->next;
+                offset = 0;
+            }
+        }
+
+        /**
+         * dereference this iterator
+         * @returns the value at which this iterator is pointing
+         */
+        reference operator * () const {
+            return leaf->data[offset];
+        }
+
+        /**
+         * dereference pointer this iterator
+         * @returns a pointer to the value
+         */
+        pointer operator -> () const {
+            return &**this;
+        }
+
+        /**
+         * increment (pre) this iterator by one, stepping to the next leaf at the end of a row
+         * @returns iterator with its NEW value
+         */
+        basic_iterator& operator ++ () {
+            if(++offset == leaf->count) {
+                leaf = leaf->next;
+                offset = 0;
+            }
+            return *this;
+        }
+
+        /**
+         * increment (post) this iterator by one
+         * @returns iterator with its OLD value
+         */
+        basic_iterator operator ++ (int) {
+            basic_iterator x = *this;
+            ++(*this);
+            return x;
+        }
+
+        /**
+         * decrement (pre) this iterator by one, stepping to the previous leaf at the start of a row
+         * @returns iterator with its NEW value
+         */
+        basic_iterator& operator -- () {
+            if(!leaf) {
+                leaf = owner->tail;
+                offset = leaf->count;
+            }
+            while(!offset) {
+                leaf = leaf->prev;
+                offset = leaf->count;
+            }
+            --offset;
+            return *this;
+        }
+
+        /**
+         * decrement (post) this iterator by one
+         * @returns iterator with its OLD value
+         */
+        basic_iterator operator -- (int) {
+            basic_iterator x = *this;
+            --(*this);
+            return x;
+        }
+    };
+
+    typedef basic_iterator<pointer, reference>             iterator;
+    typedef basic_iterator<const_pointer, const_reference> const_iterator;
+
+public:
+    // ------------
+    // constructors
+    // ------------
+
+    /**
+     * create a new, empty tree_deque
+     * @param   a the allocator to be used for this deque
+     */
+    explicit tree_deque (const allocator_type& a = allocator_type()) :
+    _a(a), _al(a), _ai(a), height(0), tree_size(0)
+    {
+        head = tail = make_leaf();
+        root = head;
+        assert(valid());
+    }
+
+    /**
+     * create a new tree_deque of size s, filled with v
+     * @param   s the size of the deque to be created
+     * @param   v the value that should be filled into all values (optional)
+     * @param   a the allocator to be used for this deque
+     */
+    explicit tree_deque (size_type s, const_reference v = value_type(), const allocator_type& a = allocator_type()) :
+    _a(a), _al(a), _ai(a), height(0), tree_size(0)
+    {
+        head = tail = make_leaf();
+        root = head;
+        try {
+            for(size_type i = 0; i < s; ++i)
+                push_back(v);
+        }
+        catch (...) {
+            free_node(root, height);
+            throw;}
+        assert(valid());
+    }
+
+    /**
+     * create a new tree_deque containing the same elements as that
+     * @param   that the deque to be replicated
+     */
+    tree_deque (const tree_deque& that) :
+    _a(that._a), _al(that._al), _ai(that._ai), height(0), tree_size(0)
+    {
+        head = tail = make_leaf();
+        root = head;
+        try {
+            for(const_iterator it = that.begin(); it != that.end(); ++it)
+                push_back(*it);
+        }
+        catch (...) {
+            free_node(root, height);
+            throw;}
+        assert(valid());
+    }
+
+    // ----------
+    // destructor
+    // ----------
+
+    /**
+     * destroy this deque and all it's members and free all memory
+     */
+    ~tree_deque () {
+        free_node(root, height);
+    }
+
+    // ----------
+    // operator =
+    // ----------
+
+    /**
+     * assignment operator, will set this to have values equivalent of rhs
+     * @param rhs the deque that is to be replicated into this
+     * @returns this
+     */
+    tree_deque& operator = (const tree_deque& rhs) {
+        if(this != &rhs) {
+            tree_deque x(rhs);
+            swap(x);
+        }
+        return *this;
+    }
+
+    // -----------
+    // operator []
+    // -----------
+
+    /**
+     * index this deque, O(log n)
+     * @param index the index in this deque to be evaluated
+     * @return a reference to the value at index
+     */
+    reference operator [] (size_type index) {
+        tree_leaf* l = find_leaf(index);
+        return l->data[index];
+    }
+
+    /**
+     * index this deque, does not allow write
+     * @param index the index in this deque to be evaluated
+     * @return a reference to the value at index in this deque (read only)
+     */
+    const_reference operator [] (size_type index) const {
+        return const_cast<tree_deque*>(this)->operator[](index);
+    }
+
+    // --
+    // at
+    // --
+
+    /**
+     * index this deque
+     * @param index the index in this deque to be evaluated
+     * @return a reference to the value at index in this deque
+     * @throws out_of_range if the index is greater or equal to size
+     */
+    reference at (size_type index) {
+        if(index >= tree_size)
+            throw std::out_of_range("at index out of range");
+        return (*this)[index];
+    }
+
+    /**
+     * index this deque (read only)
+     * @param index the index in this deque to be evaluated
+     * @return a reference to the value at index in this deque
+     * @throws out_of_range if the index is greater or equal to size
+     */
+    const_reference at (size_type index) const {
+        return const_cast<tree_deque*>(this)->at(index);
+    }
+
+    // -----
+    // front
+    // -----
+
+    /**
+     * @returns the reference to the element at the front of the deque
+     */
+    reference front () {
+        return *begin();
+    }
+
+    const_reference front () const {
+        return *begin();
+    }
+
+    // ----
+    // back
+    // ----
+
+    /**
+     * @returns the reference to the element at the back of the deque
+     */
+    reference back () {
+        return tail->data[tail->count - 1];
+    }
+
+    const_reference back () const {
+        return tail->data[tail->count - 1];
+    }
+
+    // -----
+    // begin
+    // -----
+
+    /**
+     * @returns an iterator pointing to the first value
+     */
+    iterator begin () {
+        return iterator(this, head, 0);
+    }
+
+    const_iterator begin () const {
+        return const_iterator(this, head, 0);
+    }
+
+    // ---
+    // end
+    // ---
+
+    /**
+     * @returns an iterator pointing past the last value
+     */
+    iterator end () {
+        return iterator(this, NULL, 0);
+    }
+
+    const_iterator end () const {
+        return const_iterator(this, NULL, 0);
+    }
+
+    // -----
+    // clear
+    // -----
+
+    /**
+     * destroy every element and free every row but one
+     */
+    void clear () {
+        free_node(root, height);
+        height = 0;
+        tree_size = 0;
+        head = tail = make_leaf();
+        root = head;
+        assert(valid());
+    }
+
+    // -----
+    // empty
+    // -----
+
+    /**
+     * @returns true if size == 0
+     */
+    bool empty () const {
+        return !tree_size;
+    }
+
+    // -----
+    // erase
+    // -----
+
+    /**
+     * erase the element at index, O(log n)
+     * @param index the index of the element to remove
+     */
+    void erase (size_type index) {
+        assert(index < tree_size);
+        erase_at(root, height, index);
+        --tree_size;
+        while(height && root->count == 1) {
+            tree_inner* in = static_cast<tree_inner*>(root);
+            root = in->child[0];
+            _ai.deallocate(in, 1);
+            --height;
+        }
+        assert(valid());
+    }
+
+    // ------
+    // insert
+    // ------
+
+    /**
+     * insert a value before index, O(log n)
+     * @param index where to insert, 0 <= index <= size()
+     * @param v the value to be inserted
+     */
+    void insert (size_type index, const_reference v) {
+        assert(index <= tree_size);
+        tree_node* split = insert_at(root, height, index, v);
+        if(split) {
+            tree_inner* in = make_inner();
+            in->count = 2;
+            in->child[0] = root;
+            in->child[1] = split;
+            in->sizes[1] = node_size(split, height);
+            in->sizes[0] = tree_size + 1 - in->sizes[1];
+            root = in;
+            ++height;
+        }
+        ++tree_size;
+        assert(valid());
+    }
+
+    // ---
+    // pop
+    // ---
+
+    /**
+     * removes (destroys) the value at the back of the deque
+     */
+    void pop_back () {
+        erase(tree_size - 1);
+    }
+
+    /**
+     * removes (destroys) the value at the front of the deque
+     */
+    void pop_front () {
+        erase(0);
+    }
+
+    // ----
+    // push
+    // ----
+
+    /**
+     * push a value onto the back side of this deque
+     * @param val the value to add to the deque
+     */
+    void push_back (const_reference val) {
+        insert(tree_size, val);
+    }
+
+    /**
+     * push a value onto the front side of this deque
+     * @param val the value to add to the deque
+     */
+    void push_front (const_reference val) {
+        insert(0, val);
+    }
+
+    // ----
+    // size
+    // ----
+
+    /**
+     * @returns the number of elements in this deque
+     */
+    size_type size () const {
+        return tree_size;
+    }
+
+    // ----
+    // swap
+    // ----
+
+    /**
+     * swap this deque's values with another
+     * @param other the other deque to be swapped with
+     */
+    void swap (tree_deque& other) {
+        std::swap(root, other.root);
+        std::swap(height, other.height);
+        std::swap(tree_size, other.tree_size);
+        std::swap(head, other.head);
+        std::swap(tail, other.tail);
+    }
+};
+
+#endif // TreeDeque_h